@@ -5,13 +5,21 @@
 #include "vect2.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // Affine transformation parameters when bike is turning
-bool StretchEnabled = false;
-static double StretchFactor = 1.0;
-static vect2 StretchCenter = Vect2i;
-static vect2 StretchAxis = Vect2i;
-static double StretchMetersToPixels = 1.0;
+// (per thread, so splitscreen viewports can be drawn at the same time)
+thread_local bool StretchEnabled = false;
+static thread_local double StretchFactor = 1.0;
+static thread_local vect2 StretchCenter = Vect2i;
+static thread_local vect2 StretchAxis = Vect2i;
+static thread_local double StretchMetersToPixels = 1.0;
 
 // Render a horizontal slice of pixels into the `dest` by grabbing a diagonal slice of pixel data
 // from an affine_pic.
@@ -39,6 +47,117 @@ void draw_affine_pic_row(unsigned char transparency, int length, unsigned char*
     }
 }
 
+// 16.16 fixed point
+constexpr int FIXED_SHIFT = 16;
+constexpr double FIXED_ONE = 65536.0;
+
+static inline int32_t to_fixed(double d) { return (int32_t)std::lround(d * FIXED_ONE); }
+
+// Returns true if the linear function start + i * step lies in [0, limit) at i
+static inline bool fixed_inside(int32_t start, int32_t step, int i, int32_t limit) {
+    int64_t value = (int64_t)start + (int64_t)step * i;
+    return value >= 0 && value < limit;
+}
+
+// Shrinks [*first, *last) to the indices where start + i * step lies in [0, limit).
+// The valid indices of a linear function are contiguous, so a floating-point estimate is
+// refined with exact integer checks.
+static void clip_fixed_span(int32_t start, int32_t step, int32_t limit, int* first, int* last) {
+    if (*first >= *last) {
+        return;
+    }
+    if (step == 0) {
+        if (!fixed_inside(start, 0, 0, limit)) {
+            *last = *first;
+        }
+        return;
+    }
+    double i_low = (0.0 - start) / step;
+    double i_high = ((double)limit - start) / step;
+    if (i_low > i_high) {
+        std::swap(i_low, i_high);
+    }
+    int estimate_first = (int)std::max((double)*first, std::floor(i_low) - 1.0);
+    int estimate_last = (int)std::min((double)*last, std::ceil(i_high) + 1.0);
+    if (estimate_first >= estimate_last) {
+        *last = *first;
+        return;
+    }
+    while (estimate_first < estimate_last &&
+           !fixed_inside(start, step, estimate_first, limit)) {
+        estimate_first++;
+    }
+    while (estimate_last > estimate_first &&
+           !fixed_inside(start, step, estimate_last - 1, limit)) {
+        estimate_last--;
+    }
+    *first = estimate_first;
+    *last = estimate_last;
+}
+
+// Fixed-point version of draw_affine_pic_row.
+// The row is first clipped to the span that samples inside the affine_pic, so the inner loop
+// needs no bounds checks. Pixels are gathered 8 at a time and the transparent ones are masked
+// out with a vector compare and select instead of a branch per pixel.
+void draw_affine_pic_row_fixed(unsigned char transparency, int length, unsigned char* dest,
+                               affine_pic* aff, double source_x, double source_y,
+                               double source_dx, double source_dy) {
+    int32_t fx = to_fixed(source_x);
+    int32_t fy = to_fixed(source_y);
+    int32_t fdx = to_fixed(source_dx);
+    int32_t fdy = to_fixed(source_dy);
+
+    int first = 0;
+    int last = length;
+    clip_fixed_span(fx, fdx, aff->width << FIXED_SHIFT, &first, &last);
+    clip_fixed_span(fy, fdy, aff->height << FIXED_SHIFT, &first, &last);
+    if (first >= last) {
+        return;
+    }
+
+    const unsigned char* source = aff->pixels;
+    fx += fdx * first;
+    fy += fdy * first;
+    unsigned char* d = dest + first;
+    int count = last - first;
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        unsigned char gathered[8];
+        for (int i = 0; i < 8; i++) {
+            gathered[i] = source[((fy >> FIXED_SHIFT) << 8) + (fx >> FIXED_SHIFT)];
+            fx += fdx;
+            fy += fdy;
+        }
+#if defined(__ARM_NEON)
+        uint8x8_t pixels = vld1_u8(gathered);
+        uint8x8_t transparent = vceq_u8(pixels, vdup_n_u8(transparency));
+        vst1_u8(d + x, vbsl_u8(transparent, vld1_u8(d + x), pixels));
+#elif defined(__SSE2__)
+        __m128i pixels = _mm_loadl_epi64((const __m128i*)gathered);
+        __m128i old_pixels = _mm_loadl_epi64((const __m128i*)(d + x));
+        __m128i transparent = _mm_cmpeq_epi8(pixels, _mm_set1_epi8((char)transparency));
+        __m128i blended = _mm_or_si128(_mm_and_si128(transparent, old_pixels),
+                                       _mm_andnot_si128(transparent, pixels));
+        _mm_storel_epi64((__m128i*)(d + x), blended);
+#else
+        for (int i = 0; i < 8; i++) {
+            if (gathered[i] != transparency) {
+                d[x + i] = gathered[i];
+            }
+        }
+#endif
+    }
+    for (; x < count; x++) {
+        unsigned char c = source[((fy >> FIXED_SHIFT) << 8) + (fx >> FIXED_SHIFT)];
+        if (c != transparency) {
+            d[x] = c;
+        }
+        fx += fdx;
+        fy += fdy;
+    }
+}
+
 void set_stretch_parameters(vect2 bike_center, vect2 bike_i, double stretch,
                             double meters_to_pixels) {
     StretchCenter = bike_center;
@@ -302,8 +421,8 @@ void draw_affine_pic(pic8* dest, affine_pic* aff, vect2 u, vect2 v, vect2 r) {
                 }
                 unsigned char* dest_target = dest->get_row(y);
                 dest_target += x_left;
-                draw_affine_pic_row(transparency, x2 - x1 + 1, dest_target, aff->pixels, affine_x,
-                                    affine_y, inverse_i.x, inverse_i.y);
+                draw_affine_pic_row_fixed(transparency, x2 - x1 + 1, dest_target, aff, affine_x,
+                                          affine_y, inverse_i.x, inverse_i.y);
             } else {
                 if (x1_plane > x2_plane + 1) {
                     return;
@@ -345,8 +464,8 @@ void draw_affine_pic(pic8* dest, affine_pic* aff, vect2 u, vect2 v, vect2 r) {
                 // draw!
                 unsigned char* dest_target = dest->get_row(y);
                 dest_target += x_left;
-                draw_affine_pic_row(transparency, x2 - x1 + 1, dest_target, aff->pixels, affine_x,
-                                    affine_y, inverse_i.x, inverse_i.y);
+                draw_affine_pic_row_fixed(transparency, x2 - x1 + 1, dest_target, aff, affine_x,
+                                          affine_y, inverse_i.x, inverse_i.y);
             } else {
                 // If the draw width is 0 pixels, we continue (for very thin images)
                 // If the draw width <= -1, then we are completely done rendering and we stop here
@@ -15,7 +15,17 @@ class vect2;
 //   See docs/affine_pic_render.png
 void draw_affine_pic(pic8* dest, affine_pic* aff, vect2 u, vect2 v, vect2 r);
 
-extern bool StretchEnabled;
+// Draw one destination row of an affine_pic (see affine_pic_render.cpp).
+// draw_affine_pic() uses the fixed-point version, the double version is kept as a reference
+// for pixel comparisons.
+void draw_affine_pic_row(unsigned char transparency, int length, unsigned char* dest,
+                         unsigned char* source, double source_x, double source_y, double source_dx,
+                         double source_dy);
+void draw_affine_pic_row_fixed(unsigned char transparency, int length, unsigned char* dest,
+                               affine_pic* aff, double source_x, double source_y,
+                               double source_dx, double source_dy);
+
+extern thread_local bool StretchEnabled;
 
 // Set the properties of the bike being squished during turning.
 // `bike_center` is the centerpoint of the turn.
@@ -0,0 +1,177 @@
+// bench_collision: drives bikes with random controls on levels and reports how often the
+// collision lookups of their wheels and heads are answered by the distance field alone.
+//
+// make TARGET=headless bench_collision
+// build-headless/bench_collision [--steps <n>] [--bikes <n>] [file.lev ...]
+//
+// Without file arguments every internal level is used.
+
+#include "bike_batch.h"
+#include "headless_game.h"
+#include "LEPTET.H"
+#include "physics_collision.h"
+#include "physics_init.h"
+#include "segments.h"
+#include "state.h"
+#include "world.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct lookup_counts {
+    long long lookups = 0;
+    long long empty = 0;      // No segments in the cell at all
+    long long early_out = 0;  // Segments in the cell, but the distance field says none in reach
+    long long scanned = 0;    // Segments had to be checked
+    long long candidates = 0; // Segments in the scanned cells
+
+    void add(const lookup_counts& other) {
+        lookups += other.lookups;
+        empty += other.empty;
+        early_out += other.early_out;
+        scanned += other.scanned;
+        candidates += other.candidates;
+    }
+};
+
+static void count_lookup(world* wld, vect2 r, double radius, lookup_counts* counts) {
+    collision_cell cell = wld->segs->get_collision_grid_cell(r);
+    counts->lookups++;
+    if (cell.count == 0) {
+        counts->empty++;
+    } else if (cell.clearance > radius) {
+        counts->early_out++;
+    } else {
+        counts->scanned++;
+        counts->candidates += cell.count;
+    }
+}
+
+static double percent(long long part, long long whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static void print_header() {
+    printf("%-14s %10s %7s %9s %8s %10s %9s\n", "", "lookups", "empty", "early-out", "scanned",
+           "cands/scan", "ns/lookup");
+}
+
+static void print_counts(const char* name, const lookup_counts& counts, double nanoseconds) {
+    printf("%-14s %10lld %6.1f%% %8.1f%% %7.1f%% %10.2f %9.1f\n", name, counts.lookups,
+           percent(counts.empty, counts.lookups), percent(counts.early_out, counts.lookups),
+           percent(counts.scanned, counts.lookups),
+           counts.scanned ? (double)counts.candidates / counts.scanned : 0.0,
+           counts.lookups ? nanoseconds / counts.lookups : 0.0);
+}
+
+// Changes the controls of a bike every few tenths of a second, with short volts
+static bike_controls random_controls(unsigned* seed, int step) {
+    bike_controls controls;
+    *seed = *seed * 1103515245u + 12345u;
+    unsigned bits = *seed >> 8;
+    controls.gas = (bits & 3) != 0;
+    controls.brake = (bits & 12) == 12;
+    controls.right_volt = (bits & 0x70) == 0x70 && step % 97 == 0;
+    controls.left_volt = (bits & 0x380) == 0x380 && step % 89 == 0;
+    return controls;
+}
+
+int main(int argc, char** argv) {
+    int steps = 20000;
+    int bike_count = 32;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bikes") == 0 && i + 1 < argc) {
+            bike_count = atoi(argv[++i]);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (steps <= 0 || bike_count <= 0) {
+        printf("--steps and --bikes must be positive\n");
+        return 1;
+    }
+
+    headless_game_init();
+    if (files.empty()) {
+        for (int i = 1; i < INTERNAL_LEVEL_COUNT; i++) {
+            char filename[20];
+            sprintf(filename, "QWQUU%03d.LEV", i);
+            files.push_back(filename);
+        }
+    }
+
+    printf("%d bikes x %d steps per level, lookups of both wheels and the head\n", bike_count,
+           steps);
+    print_header();
+
+    lookup_counts all;
+    double all_nanoseconds = 0.0;
+    for (const std::string& filename : files) {
+        world wld(filename.c_str());
+        bike_batch batch(&wld, bike_count);
+        std::vector<unsigned> seeds(bike_count);
+        std::vector<bike_controls> controls(bike_count);
+        for (int k = 0; k < bike_count; k++) {
+            seeds[k] = 1 + k;
+        }
+
+        // Positions looked up by the step, replayed through get_two_anchor_points() for the time
+        std::vector<vect2> positions;
+        std::vector<double> radii;
+        lookup_counts counts;
+        for (int step = 0; step < steps; step++) {
+            for (int k = 0; k < bike_count; k++) {
+                if (batch.dead(k)) {
+                    batch.set(k, *wld.motor1);
+                }
+                if (step % 50 == 0) {
+                    controls[k] = random_controls(&seeds[k], step);
+                } else {
+                    controls[k].right_volt = controls[k].left_volt = false;
+                }
+            }
+            batch.step(step * 0.0055, 0.0055, controls.data());
+
+            for (int k = 0; k < bike_count; k++) {
+                motorst mot;
+                batch.get(k, &mot);
+                const rigidbody* wheels[2] = {&mot.left_wheel, &mot.right_wheel};
+                for (const rigidbody* wheel : wheels) {
+                    count_lookup(&wld, wheel->r, wheel->radius, &counts);
+                    positions.push_back(wheel->r);
+                    radii.push_back(wheel->radius);
+                }
+                count_lookup(&wld, mot.head_r, HeadRadius, &counts);
+                positions.push_back(mot.head_r);
+                radii.push_back(HeadRadius);
+            }
+        }
+
+        int anchor_points = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < positions.size(); i++) {
+            vect2 point1, point2;
+            anchor_points += get_two_anchor_points(&wld, positions[i], radii[i], &point1, &point2);
+        }
+        double nanoseconds = std::chrono::duration<double, std::nano>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+        // Keeps the timed loop from being optimized away
+        if (anchor_points < 0) {
+            printf("?\n");
+        }
+
+        print_counts(filename.c_str(), counts, nanoseconds);
+        all.add(counts);
+        all_nanoseconds += nanoseconds;
+    }
+    print_counts("all", all, all_nanoseconds);
+
+    return 0;
+}
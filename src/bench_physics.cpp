@@ -0,0 +1,396 @@
+// bench_physics: rides a bike with scripted gas, brake and volts on levels and reports the time
+// of leptet() substeps and of rigidbody_movement() calls, how many collision candidates the
+// lookups check, and cache misses where the kernel exposes the hardware counters.
+//
+// make TARGET=headless bench_physics
+// build-headless/bench_physics [--steps <n>] [file.lev ...]
+//
+// Without file arguments every internal level and the synthetic stress levels are used:
+// dense vertex clusters, a long thin corridor and a huge open map (an extended level).
+
+#include "eol_settings.h"
+#include "headless_game.h"
+#include "LEPTET.H"
+#include "level.h"
+#include "object.h"
+#include "physics_init.h"
+#include "physics_move.h"
+#include "platform_utils.h"
+#include "polygon.h"
+#include "segments.h"
+#include "state.h"
+#include "world.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Cache misses of the calling thread between start() and stop(), -1 if the counter can't be
+// opened (no hardware counters, or not allowed by perf_event_paranoid)
+class cache_miss_counter {
+    int fd;
+
+  public:
+    cache_miss_counter() {
+        fd = -1;
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~cache_miss_counter() {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    long long stop() {
+#ifdef __linux__
+        long long count = 0;
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) == sizeof(count)) {
+                return count;
+            }
+        }
+#endif
+        return -1;
+    }
+
+    cache_miss_counter(const cache_miss_counter&) = delete;
+    cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+};
+
+struct level_result {
+    int substeps = 0;
+    double substep_nanoseconds = 0.0;
+    long long substep_misses = 0;
+    int movements = 0;
+    double movement_nanoseconds = 0.0;
+    long long movement_misses = 0;
+    long long lookups = 0;
+    long long candidates = 0;
+    int deaths = 0;
+
+    void add(const level_result& other) {
+        substeps += other.substeps;
+        substep_nanoseconds += other.substep_nanoseconds;
+        movements += other.movements;
+        movement_nanoseconds += other.movement_nanoseconds;
+        lookups += other.lookups;
+        candidates += other.candidates;
+        deaths += other.deaths;
+        // Unavailable anywhere makes the total unavailable
+        if (substep_misses < 0 || other.substep_misses < 0) {
+            substep_misses = -1;
+        } else {
+            substep_misses += other.substep_misses;
+        }
+        if (movement_misses < 0 || other.movement_misses < 0) {
+            movement_misses = -1;
+        } else {
+            movement_misses += other.movement_misses;
+        }
+    }
+};
+
+static double per(double part, long long whole) { return whole ? part / whole : 0.0; }
+
+static void print_header() {
+    printf("%-18s %9s %11s %9s %9s %9s %10s %7s\n", "", "substeps", "ns/substep", "miss/step",
+           "ns/move", "miss/move", "cands/look", "deaths");
+}
+
+static void print_misses(long long misses, long long count) {
+    if (misses < 0) {
+        printf(" %9s", "-");
+    } else {
+        printf(" %9.2f", per((double)misses, count));
+    }
+}
+
+static void print_result(const char* name, const level_result& result) {
+    printf("%-18s %9d %11.1f", name, result.substeps,
+           per(result.substep_nanoseconds, result.substeps));
+    print_misses(result.substep_misses, result.substeps);
+    printf(" %9.1f", per(result.movement_nanoseconds, result.movements));
+    print_misses(result.movement_misses, result.movements);
+    printf(" %10.2f %7d\n", per((double)result.candidates, result.lookups), result.deaths);
+}
+
+// Same script for every level: mostly gas, braking now and then, and a volt every few seconds
+struct scripted_input {
+    int gas;
+    int brake;
+    int right_volt;
+    int left_volt;
+};
+
+static scripted_input script(int step) {
+    int phase = (step / 400) % 4;
+    scripted_input input;
+    input.gas = phase != 3;
+    input.brake = phase == 3 && step % 400 < 100;
+    input.right_volt = step % 700 == 350;
+    input.left_volt = step % 1100 == 550;
+    return input;
+}
+
+// Segments checked by a lookup of get_two_anchor_points(), 0 if the distance field answers it
+static int lookup_candidates(world* wld, vect2 r, double radius) {
+    collision_cell cell = wld->segs->get_collision_grid_cell(r);
+    if (cell.clearance > radius) {
+        return 0;
+    }
+    return cell.count;
+}
+
+// Substeps the bike from `start`, restarting it whenever it dies. `states` gets both wheels
+// before every substep, if given.
+static int ride(world* wld, const world_snapshot& start, int steps,
+                std::vector<rigidbody>* states) {
+    constexpr double DT = 0.0055;
+    wld->restore(start);
+    int deaths = 0;
+    for (int step = 0; step < steps; step++) {
+        if (states) {
+            states->push_back(wld->motor1->left_wheel);
+            states->push_back(wld->motor1->right_wheel);
+        }
+        scripted_input input = script(step);
+        leptet(wld, wld->motor1, step * DT, DT, input.gas, input.brake, input.right_volt,
+               input.left_volt);
+        if (!vizsgalat(wld, wld->motor1)) {
+            wld->restore(start);
+            deaths++;
+        }
+        wld->events.reset();
+    }
+    return deaths;
+}
+
+static level_result bench_level(world* wld, int steps) {
+    constexpr double DT = 0.0055;
+    level_result result;
+    world_snapshot start;
+    wld->snapshot(&start, 0.0);
+    cache_miss_counter counter;
+
+    // Whole substeps, timed without any bookkeeping
+    auto begin = std::chrono::steady_clock::now();
+    counter.start();
+    result.deaths = ride(wld, start, steps, nullptr);
+    result.substep_misses = counter.stop();
+    result.substep_nanoseconds =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    result.substeps = steps;
+
+    // The same ride again to collect the wheels, the physics are deterministic
+    std::vector<rigidbody> states;
+    states.reserve(2 * steps);
+    ride(wld, start, steps, &states);
+
+    // Wheel movements with collision, pushed by gravity only
+    begin = std::chrono::steady_clock::now();
+    counter.start();
+    for (const rigidbody& state : states) {
+        rigidbody rb = state;
+        rigidbody_movement(wld, &rb, vect2(0.0, -rb.mass * Gravity), 0.0, DT, true);
+    }
+    result.movement_misses = counter.stop();
+    result.movement_nanoseconds =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    result.movements = (int)states.size();
+
+    for (const rigidbody& state : states) {
+        result.lookups++;
+        result.candidates += lookup_candidates(wld, state.r, state.radius);
+    }
+    return result;
+}
+
+// Polygon through `points`, given with y pointing up
+static polygon* make_polygon(const std::vector<vect2>& points) {
+    polygon* poly = new polygon;
+    while (poly->vertex_count < (int)points.size()) {
+        poly->insert_vertex(poly->vertex_count - 1);
+    }
+    for (int i = 0; i < (int)points.size(); i++) {
+        poly->set_vertex(i, points[i].x, -points[i].y);
+    }
+    return poly;
+}
+
+// Level with `polygons`, the start at `start` and the exit out of reach at `exit` (y up)
+static level* make_level(const std::vector<std::vector<vect2>>& polygons, vect2 start,
+                         vect2 exit) {
+    level* lev = new level;
+    for (polygon* poly : lev->polygons) {
+        delete poly;
+    }
+    lev->polygons.clear();
+    for (const std::vector<vect2>& points : polygons) {
+        lev->polygons.push_back(make_polygon(points));
+    }
+    for (object* obj : lev->objects) {
+        if (obj->type == object::Type::Start) {
+            obj->r = vect2(start.x, -start.y);
+        } else {
+            obj->r = vect2(exit.x, -exit.y);
+        }
+    }
+    return lev;
+}
+
+static double random_unit(unsigned* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return ((*seed >> 8) & 0xffff) / 65535.0;
+}
+
+// 40 m room with a rough floor of a vertex every 2 cm, and rocks of 150 vertices on it
+static level* dense_level() {
+    unsigned seed = 1;
+    std::vector<std::vector<vect2>> polygons(1);
+    for (int i = 0; i <= 2000; i++) {
+        polygons[0].push_back(vect2(-20.0 + i * 0.02, 0.02 * random_unit(&seed)));
+    }
+    polygons[0].push_back(vect2(20.0, 12.0));
+    polygons[0].push_back(vect2(-20.0, 12.0));
+    for (int rock = 0; rock < 12; rock++) {
+        vect2 center(-14.0 + rock * 3.0, 0.1);
+        std::vector<vect2> points;
+        for (int i = 0; i < 150; i++) {
+            double angle = TWO_PI * i / 150;
+            double radius = 0.4 + 0.05 * random_unit(&seed);
+            points.push_back(center + vect2(radius * cos(angle), 0.6 * radius * sin(angle)));
+        }
+        polygons.push_back(points);
+    }
+    return make_level(polygons, vect2(-18.0, 1.5), vect2(18.0, 10.0));
+}
+
+// 180 m long wavy corridor, 3 m high
+static level* corridor_level() {
+    std::vector<std::vector<vect2>> polygons(1);
+    for (int i = 0; i <= 720; i++) {
+        double x = -90.0 + i * 0.25;
+        polygons[0].push_back(vect2(x, 1.5 * sin(x / 6.0)));
+    }
+    for (int i = 720; i >= 0; i--) {
+        double x = -90.0 + i * 0.25;
+        polygons[0].push_back(vect2(x, 1.5 * sin(x / 6.0) + 3.0));
+    }
+    return make_level(polygons, vect2(-88.0, 1.5 * sin(-88.0 / 6.0) + 0.5),
+                      vect2(88.0, 1.5 * sin(88.0 / 6.0) + 0.5));
+}
+
+// 900 m square with hills and 300 floating platforms, mostly empty collision grid cells
+static level* open_level() {
+    unsigned seed = 2;
+    std::vector<std::vector<vect2>> polygons(1);
+    for (int i = 0; i <= 450; i++) {
+        double x = -450.0 + i * 2.0;
+        polygons[0].push_back(vect2(x, 4.0 * sin(x / 25.0) + 1.0 * sin(x / 7.0)));
+    }
+    polygons[0].push_back(vect2(450.0, 900.0));
+    polygons[0].push_back(vect2(-450.0, 900.0));
+    for (int i = 0; i < 300; i++) {
+        vect2 corner(-440.0 + 870.0 * random_unit(&seed), 20.0 + 860.0 * random_unit(&seed));
+        polygons.push_back({corner, corner + vect2(4.0, 0.0), corner + vect2(4.0, 1.0),
+                            corner + vect2(0.0, 1.0)});
+    }
+    return make_level(polygons, vect2(0.0, 6.0), vect2(400.0, 880.0));
+}
+
+int main(int argc, char** argv) {
+    int steps = 20000;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = atoi(argv[++i]);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (steps <= 0) {
+        printf("--steps must be positive\n");
+        return 1;
+    }
+
+    headless_game_init();
+    bool synthetic = files.empty();
+    if (files.empty()) {
+        for (int i = 1; i < INTERNAL_LEVEL_COUNT; i++) {
+            char filename[20];
+            sprintf(filename, "QWQUU%03d.LEV", i);
+            files.push_back(filename);
+        }
+    }
+
+    {
+        cache_miss_counter counter;
+        counter.start();
+        if (counter.stop() < 0) {
+            printf("Cache miss counters not available, shown as -\n");
+        }
+    }
+    printf("%d substeps per level, move = rigidbody_movement() of a wheel\n", steps);
+    print_header();
+
+    level_result all;
+    for (const std::string& filename : files) {
+        world wld(filename.c_str());
+        level_result result = bench_level(&wld, steps);
+        print_result(filename.c_str(), result);
+        all.add(result);
+    }
+
+    if (synthetic) {
+        // The open map is larger than the original game allows
+        EolSettings->set_extended_levels(true);
+        struct {
+            const char* name;
+            level* (*make)();
+        } stress_levels[] = {
+            {"dense clusters", dense_level},
+            {"thin corridor", corridor_level},
+            {"huge open map", open_level},
+        };
+        for (const auto& stress : stress_levels) {
+            world wld(stress.make());
+            level_result result = bench_level(&wld, steps);
+            print_result(stress.name, result);
+            all.add(result);
+        }
+    }
+    print_result("all", all);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+// bench_render: replays .rec files through lejatszo_r()/kirajzol320() on the headless platform at
+// a fixed timestep and reports frame and per-stage render times.
+//
+// make TARGET=headless bench_render
+// build-headless/bench_render [--step <ms>] [--threads <n>] [file.rec ...]
+//
+// Without file arguments every rec/*.rec and the built-in demos are replayed.
+
+#include "eol_settings.h"
+#include "headless_game.h"
+#include "LEJATSZO.H"
+#include "platform_headless.h"
+#include "recorder.h"
+#include "render_profile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+constexpr int STAGE_COUNT = (int)RenderStage::Count;
+static const char* StageNames[STAGE_COUNT] = {"ground", "objects", "bikes", "fore",
+                                              "view",   "timers",  "present"};
+
+// Milliseconds per frame, and per stage of that frame
+struct frame_samples {
+    std::vector<double> frame;
+    std::vector<double> stage[STAGE_COUNT];
+
+    void append(const frame_samples& other) {
+        frame.insert(frame.end(), other.frame.begin(), other.frame.end());
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            stage[i].insert(stage[i].end(), other.stage[i].begin(), other.stage[i].end());
+        }
+    }
+};
+
+static frame_samples* CurrentSamples = nullptr;
+static std::chrono::steady_clock::time_point LastPresent;
+static long long LastStageNanoseconds[STAGE_COUNT];
+static bool FirstFrame = true;
+
+// After the present stage of the frame was added, unlike a present hook that runs inside it
+static void bench_frame_done() {
+    auto now = std::chrono::steady_clock::now();
+    long long stage_now[STAGE_COUNT];
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        stage_now[i] = RenderStageNanoseconds[i];
+    }
+
+    // The first frame also pays for level setup, leave it out
+    if (!FirstFrame && CurrentSamples) {
+        CurrentSamples->frame.push_back(
+            std::chrono::duration<double, std::milli>(now - LastPresent).count());
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            CurrentSamples->stage[i].push_back((stage_now[i] - LastStageNanoseconds[i]) / 1.0e6);
+        }
+    }
+    FirstFrame = false;
+
+    LastPresent = now;
+    memcpy(LastStageNanoseconds, stage_now, sizeof(stage_now));
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static void print_header() {
+    printf("%-14s %7s %8s %8s", "", "frames", "median", "p99");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        printf(" %8s", StageNames[i]);
+    }
+    printf("\n");
+}
+
+static void print_samples(const char* name, const frame_samples& samples) {
+    printf("%-14s %7d %8.3f %8.3f", name, (int)samples.frame.size(),
+           percentile(samples.frame, 0.5), percentile(samples.frame, 0.99));
+    // Stage columns are medians
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        printf(" %8.3f", percentile(samples.stage[i], 0.5));
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    double step = 1000.0 / 60.0;
+    int threads = 0;
+    std::vector<replay_file> files;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            step = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            files.push_back({argv[i], false});
+        }
+    }
+
+    headless_game_init();
+    if (threads > 0) {
+        EolSettings->set_render_threads(threads);
+    }
+    if (files.empty()) {
+        files = headless_replay_files();
+    }
+
+    headless_set_frame_step(step);
+    RenderFrameHook = bench_frame_done;
+    RenderProfiling = true;
+
+    printf("Virtual frame step %.3f ms, %d render thread(s), times in ms\n", step,
+           EolSettings->render_threads());
+    print_header();
+
+    std::map<std::string, frame_samples> levels;
+    for (const replay_file& rec : files) {
+        if (!headless_load_replay(rec)) {
+            continue;
+        }
+
+        frame_samples samples;
+        CurrentSamples = &samples;
+        FirstFrame = true;
+        lejatszo_r(Rec1->level_filename, 0);
+        CurrentSamples = nullptr;
+
+        print_samples(rec.filename.c_str(), samples);
+        levels[Rec1->level_filename].append(samples);
+    }
+
+    printf("\nPer level:\n");
+    print_header();
+    frame_samples all;
+    for (const auto& level : levels) {
+        print_samples(level.first.c_str(), level.second);
+        all.append(level.second);
+    }
+    print_samples("all", all);
+
+    return 0;
+}
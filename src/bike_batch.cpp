@@ -0,0 +1,378 @@
+#include "bike_batch.h"
+#include "LEPTET.H"
+#include "main.h"
+#include "physics_collision.h"
+#include "physics_init.h"
+#include "world.h"
+#include <cmath>
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Two doubles per SIMD register. Each lane does exactly the IEEE operation the scalar code in
+// LEPTET.CPP does, in the same order, so the results are identical.
+#if defined(__ARM_NEON) && defined(__aarch64__)
+typedef float64x2_t lanes;
+typedef uint64x2_t lanes_mask;
+static inline lanes lanes_load(const double* p) { return vld1q_f64(p); }
+static inline void lanes_store(double* p, lanes a) { vst1q_f64(p, a); }
+static inline lanes lanes_set(double a) { return vdupq_n_f64(a); }
+static inline lanes lanes_add(lanes a, lanes b) { return vaddq_f64(a, b); }
+static inline lanes lanes_sub(lanes a, lanes b) { return vsubq_f64(a, b); }
+static inline lanes lanes_mul(lanes a, lanes b) { return vmulq_f64(a, b); }
+static inline lanes lanes_div(lanes a, lanes b) { return vdivq_f64(a, b); }
+static inline lanes lanes_sqrt(lanes a) { return vsqrtq_f64(a); }
+static inline lanes lanes_neg(lanes a) { return vnegq_f64(a); }
+static inline lanes_mask lanes_less(lanes a, lanes b) { return vcltq_f64(a, b); }
+static inline lanes_mask lanes_greater(lanes a, lanes b) { return vcgtq_f64(a, b); }
+static inline lanes_mask lanes_equal(lanes a, lanes b) { return vceqq_f64(a, b); }
+static inline lanes_mask lanes_or(lanes_mask a, lanes_mask b) { return vorrq_u64(a, b); }
+static inline lanes lanes_select(lanes_mask m, lanes a, lanes b) { return vbslq_f64(m, a, b); }
+#elif defined(__SSE2__)
+typedef __m128d lanes;
+typedef __m128d lanes_mask;
+static inline lanes lanes_load(const double* p) { return _mm_loadu_pd(p); }
+static inline void lanes_store(double* p, lanes a) { _mm_storeu_pd(p, a); }
+static inline lanes lanes_set(double a) { return _mm_set1_pd(a); }
+static inline lanes lanes_add(lanes a, lanes b) { return _mm_add_pd(a, b); }
+static inline lanes lanes_sub(lanes a, lanes b) { return _mm_sub_pd(a, b); }
+static inline lanes lanes_mul(lanes a, lanes b) { return _mm_mul_pd(a, b); }
+static inline lanes lanes_div(lanes a, lanes b) { return _mm_div_pd(a, b); }
+static inline lanes lanes_sqrt(lanes a) { return _mm_sqrt_pd(a); }
+static inline lanes lanes_neg(lanes a) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+static inline lanes_mask lanes_less(lanes a, lanes b) { return _mm_cmplt_pd(a, b); }
+static inline lanes_mask lanes_greater(lanes a, lanes b) { return _mm_cmpgt_pd(a, b); }
+static inline lanes_mask lanes_equal(lanes a, lanes b) { return _mm_cmpeq_pd(a, b); }
+static inline lanes_mask lanes_or(lanes_mask a, lanes_mask b) { return _mm_or_pd(a, b); }
+static inline lanes lanes_select(lanes_mask m, lanes a, lanes b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+}
+#else
+struct lanes {
+    double v[2];
+};
+struct lanes_mask {
+    bool v[2];
+};
+static inline lanes lanes_load(const double* p) { return {{p[0], p[1]}}; }
+static inline void lanes_store(double* p, lanes a) {
+    p[0] = a.v[0];
+    p[1] = a.v[1];
+}
+static inline lanes lanes_set(double a) { return {{a, a}}; }
+static inline lanes lanes_add(lanes a, lanes b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1]}}; }
+static inline lanes lanes_sub(lanes a, lanes b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1]}}; }
+static inline lanes lanes_mul(lanes a, lanes b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1]}}; }
+static inline lanes lanes_div(lanes a, lanes b) { return {{a.v[0] / b.v[0], a.v[1] / b.v[1]}}; }
+static inline lanes lanes_sqrt(lanes a) { return {{sqrt(a.v[0]), sqrt(a.v[1])}}; }
+static inline lanes lanes_neg(lanes a) { return {{-a.v[0], -a.v[1]}}; }
+static inline lanes_mask lanes_less(lanes a, lanes b) {
+    return {{a.v[0] < b.v[0], a.v[1] < b.v[1]}};
+}
+static inline lanes_mask lanes_greater(lanes a, lanes b) {
+    return {{a.v[0] > b.v[0], a.v[1] > b.v[1]}};
+}
+static inline lanes_mask lanes_equal(lanes a, lanes b) {
+    return {{a.v[0] == b.v[0], a.v[1] == b.v[1]}};
+}
+static inline lanes_mask lanes_or(lanes_mask a, lanes_mask b) {
+    return {{a.v[0] || b.v[0], a.v[1] || b.v[1]}};
+}
+static inline lanes lanes_select(lanes_mask m, lanes a, lanes b) {
+    return {{m.v[0] ? a.v[0] : b.v[0], m.v[1] ? a.v[1] : b.v[1]}};
+}
+#endif
+constexpr int LANES = 2;
+
+// vect2::length() of (x, y), including its Newton step
+static inline lanes lanes_length(lanes x, lanes y) {
+    lanes a = lanes_add(lanes_mul(x, x), lanes_mul(y, y));
+    lanes x1 = lanes_sqrt(a);
+    lanes newton = lanes_mul(lanes_set(.5), lanes_add(x1, lanes_div(a, x1)));
+    return lanes_select(lanes_equal(x1, lanes_set(0.0)), lanes_set(0.0), newton);
+}
+
+void rigidbody_lanes::resize(int count) {
+    rotation.resize(count);
+    angular_velocity.resize(count);
+    radius.resize(count);
+    mass.resize(count);
+    inertia.resize(count);
+    rx.resize(count);
+    ry.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+}
+
+void rigidbody_lanes::set(int index, const rigidbody& rb) {
+    rotation[index] = rb.rotation;
+    angular_velocity[index] = rb.angular_velocity;
+    radius[index] = rb.radius;
+    mass[index] = rb.mass;
+    inertia[index] = rb.inertia;
+    rx[index] = rb.r.x;
+    ry[index] = rb.r.y;
+    vx[index] = rb.v.x;
+    vy[index] = rb.v.y;
+}
+
+void rigidbody_lanes::get(int index, rigidbody* rb) const {
+    rb->rotation = rotation[index];
+    rb->angular_velocity = angular_velocity[index];
+    rb->radius = radius[index];
+    rb->mass = mass[index];
+    rb->inertia = inertia[index];
+    rb->r = vect2(rx[index], ry[index]);
+    rb->v = vect2(vx[index], vy[index]);
+}
+
+void wheel_force_lanes::resize(int count) {
+    wheel_x.resize(count);
+    wheel_y.resize(count);
+    body_x.resize(count);
+    body_y.resize(count);
+    body_torque.resize(count);
+}
+
+bike_batch::bike_batch(world* w, int n) {
+    if (n <= 0) {
+        internal_error("bike_batch::bike_batch count <= 0!");
+    }
+    wld = w;
+    count = n;
+    lane_count = (n + LANES - 1) / LANES * LANES;
+
+    bike.resize(lane_count);
+    left_wheel.resize(lane_count);
+    right_wheel.resize(lane_count);
+    head_x.resize(lane_count);
+    head_y.resize(lane_count);
+    flipped_bike.resize(lane_count);
+    flipped_camera.resize(lane_count);
+    gravity_direction.resize(lane_count);
+    body_x.resize(lane_count);
+    body_y.resize(lane_count);
+    body_vx.resize(lane_count);
+    body_vy.resize(lane_count);
+    apple_count.resize(lane_count);
+    prev_brake.resize(lane_count);
+    left_wheel_brake_rotation.resize(lane_count);
+    right_wheel_brake_rotation.resize(lane_count);
+    volting_right.resize(lane_count);
+    volting_left.resize(lane_count);
+    right_volt_time.resize(lane_count);
+    left_volt_time.resize(lane_count);
+    angular_velocity_pre_right_volt.resize(lane_count);
+    angular_velocity_pre_left_volt.resize(lane_count);
+    is_dead.resize(lane_count);
+
+    axis_x.resize(lane_count);
+    axis_y.resize(lane_count);
+    left_torque.resize(lane_count);
+    right_torque.resize(lane_count);
+    left_forces.resize(lane_count);
+    right_forces.resize(lane_count);
+
+    // Padding lanes carry a real bike too, so their (ignored) math stays finite
+    for (int i = 0; i < lane_count; i++) {
+        set(i, *wld->motor1);
+    }
+}
+
+void bike_batch::store(int index, const motorst& mot) {
+    bike.set(index, mot.bike);
+    left_wheel.set(index, mot.left_wheel);
+    right_wheel.set(index, mot.right_wheel);
+    head_x[index] = mot.head_r.x;
+    head_y[index] = mot.head_r.y;
+    flipped_bike[index] = mot.flipped_bike;
+    flipped_camera[index] = mot.flipped_camera;
+    gravity_direction[index] = (int)mot.gravity_direction;
+    body_x[index] = mot.body_r.x;
+    body_y[index] = mot.body_r.y;
+    body_vx[index] = mot.body_v.x;
+    body_vy[index] = mot.body_v.y;
+    apple_count[index] = mot.apple_count;
+    prev_brake[index] = mot.prev_brake;
+    left_wheel_brake_rotation[index] = mot.left_wheel_brake_rotation;
+    right_wheel_brake_rotation[index] = mot.right_wheel_brake_rotation;
+    volting_right[index] = mot.volting_right;
+    volting_left[index] = mot.volting_left;
+    right_volt_time[index] = mot.right_volt_time;
+    left_volt_time[index] = mot.left_volt_time;
+    angular_velocity_pre_right_volt[index] = mot.angular_velocity_pre_right_volt;
+    angular_velocity_pre_left_volt[index] = mot.angular_velocity_pre_left_volt;
+}
+
+void bike_batch::set(int index, const motorst& mot) {
+    store(index, mot);
+    is_dead[index] = 0;
+}
+
+void bike_batch::get(int index, motorst* mot) const {
+    bike.get(index, &mot->bike);
+    left_wheel.get(index, &mot->left_wheel);
+    right_wheel.get(index, &mot->right_wheel);
+    mot->head_r = vect2(head_x[index], head_y[index]);
+    mot->flipped_bike = flipped_bike[index];
+    mot->flipped_camera = flipped_camera[index];
+    mot->gravity_direction = (MotorGravity)gravity_direction[index];
+    mot->body_r = vect2(body_x[index], body_y[index]);
+    mot->body_v = vect2(body_vx[index], body_vy[index]);
+    mot->apple_count = apple_count[index];
+    mot->prev_brake = prev_brake[index];
+    mot->left_wheel_brake_rotation = left_wheel_brake_rotation[index];
+    mot->right_wheel_brake_rotation = right_wheel_brake_rotation[index];
+    mot->volting_right = volting_right[index];
+    mot->volting_left = volting_left[index];
+    mot->right_volt_time = right_volt_time[index];
+    mot->left_volt_time = left_volt_time[index];
+    mot->angular_velocity_pre_right_volt = angular_velocity_pre_right_volt[index];
+    mot->angular_velocity_pre_left_volt = angular_velocity_pre_left_volt[index];
+}
+
+// erokszamitasa() for every bike, without the friction sound. Dead bikes are computed too, their
+// forces are just never used.
+void bike_batch::spring_forces(const rigidbody_lanes& wheel, double wheel_dx, double wheel_dy,
+                               const std::vector<double>& torque, wheel_force_lanes* forces) {
+    lanes kordx = lanes_set(wheel_dx);
+    lanes kordy = lanes_set(wheel_dy);
+    lanes tension = lanes_set(SpringTensionCoefficient);
+    lanes resistance = lanes_set(SpringResistanceCoefficient);
+    lanes zero = lanes_set(0.0);
+    for (int k = 0; k < lane_count; k += LANES) {
+        lanes ix = lanes_load(&axis_x[k]);
+        lanes iy = lanes_load(&axis_y[k]);
+        lanes jx = lanes_neg(iy);
+        lanes jy = ix;
+        lanes bike_rx = lanes_load(&bike.rx[k]);
+        lanes bike_ry = lanes_load(&bike.ry[k]);
+        lanes wheel_rx = lanes_load(&wheel.rx[k]);
+        lanes wheel_ry = lanes_load(&wheel.ry[k]);
+
+        // Spring pulling the wheel towards its place on the bike
+        lanes gumis_x = lanes_add(lanes_mul(ix, kordx), lanes_mul(jx, kordy));
+        lanes gumis_y = lanes_add(lanes_mul(iy, kordx), lanes_mul(jy, kordy));
+        lanes gumi_x = lanes_sub(lanes_add(gumis_x, bike_rx), wheel_rx);
+        lanes gumi_y = lanes_sub(lanes_add(gumis_y, bike_ry), wheel_ry);
+        lanes limit = lanes_set(0.0001);
+        lanes minus_limit = lanes_set(-0.0001);
+        lanes_mask stretched = lanes_or(
+            lanes_or(lanes_less(gumi_x, minus_limit), lanes_greater(gumi_x, limit)),
+            lanes_or(lanes_less(gumi_y, minus_limit), lanes_greater(gumi_y, limit)));
+
+        lanes rudhossz = lanes_length(gumis_x, gumis_y);
+        lanes recrud = lanes_div(lanes_set(1.0), rudhossz);
+        lanes rudegys_x = lanes_mul(gumis_x, recrud);
+        lanes rudegys_y = lanes_mul(gumis_y, recrud);
+        lanes rudegysmer_x = lanes_neg(rudegys_y);
+        lanes rudegysmer_y = rudegys_x;
+        lanes fsugar = lanes_mul(
+            lanes_add(lanes_mul(gumi_x, rudegys_x), lanes_mul(gumi_y, rudegys_y)), tension);
+        lanes ftang = lanes_mul(
+            lanes_add(lanes_mul(gumi_x, rudegysmer_x), lanes_mul(gumi_y, rudegysmer_y)), tension);
+        lanes fkerek_x =
+            lanes_add(lanes_mul(rudegys_x, fsugar), lanes_mul(rudegysmer_x, ftang));
+        lanes fkerek_y =
+            lanes_add(lanes_mul(rudegys_y, fsugar), lanes_mul(rudegysmer_y, ftang));
+        fkerek_x = lanes_select(stretched, fkerek_x, zero);
+        fkerek_y = lanes_select(stretched, fkerek_y, zero);
+        lanes ftest_x = lanes_select(stretched, lanes_sub(zero, fkerek_x), zero);
+        lanes ftest_y = lanes_select(stretched, lanes_sub(zero, fkerek_y), zero);
+        lanes mtest = lanes_select(stretched, lanes_mul(lanes_neg(ftang), rudhossz), zero);
+
+        // Damping of the wheel relative to the bike, and the wheel torque
+        lanes koto_x = lanes_sub(wheel_rx, bike_rx);
+        lanes koto_y = lanes_sub(wheel_ry, bike_ry);
+        lanes kotol = lanes_length(koto_x, koto_y);
+        lanes reckotol = lanes_div(lanes_set(1.0), kotol);
+        lanes kotoe_x = lanes_mul(koto_x, reckotol);
+        lanes kotoe_y = lanes_mul(koto_y, reckotol);
+        lanes kotomer_x = lanes_neg(koto_y);
+        lanes kotomer_y = koto_x;
+        lanes kotoemer_x = lanes_neg(kotoe_y);
+        lanes kotoemer_y = kotoe_x;
+        lanes omega = lanes_load(&bike.angular_velocity[k]);
+        lanes relv_x = lanes_sub(lanes_add(lanes_mul(kotomer_x, omega), lanes_load(&bike.vx[k])),
+                                 lanes_load(&wheel.vx[k]));
+        lanes relv_y = lanes_sub(lanes_add(lanes_mul(kotomer_y, omega), lanes_load(&bike.vy[k])),
+                                 lanes_load(&wheel.vy[k]));
+        lanes vlong = lanes_add(lanes_mul(relv_x, kotoe_x), lanes_mul(relv_y, kotoe_y));
+        lanes vtang = lanes_add(lanes_mul(relv_x, kotoemer_x), lanes_mul(relv_y, kotoemer_y));
+        lanes long_scale = lanes_mul(vlong, resistance);
+        lanes tang_scale = lanes_mul(vtang, resistance);
+        lanes fklong_x = lanes_mul(kotoe_x, long_scale);
+        lanes fklong_y = lanes_mul(kotoe_y, long_scale);
+        lanes fktang_x = lanes_mul(kotoemer_x, tang_scale);
+        lanes fktang_y = lanes_mul(kotoemer_y, tang_scale);
+        lanes nyom_scale = lanes_mul(lanes_load(&torque[k]), reckotol);
+        lanes ftestnyom_x = lanes_mul(kotoemer_x, nyom_scale);
+        lanes ftestnyom_y = lanes_mul(kotoemer_y, nyom_scale);
+
+        fkerek_x = lanes_sub(lanes_add(lanes_add(fkerek_x, fklong_x), fktang_x), ftestnyom_x);
+        fkerek_y = lanes_sub(lanes_add(lanes_add(fkerek_y, fklong_y), fktang_y), ftestnyom_y);
+        lanes fktang_nyomatek =
+            lanes_add(lanes_mul(fktang_x, kotomer_x), lanes_mul(fktang_y, kotomer_y));
+        mtest = lanes_add(mtest, lanes_neg(fktang_nyomatek));
+        ftest_x = lanes_add(lanes_sub(lanes_sub(ftest_x, fklong_x), fktang_x), ftestnyom_x);
+        ftest_y = lanes_add(lanes_sub(lanes_sub(ftest_y, fklong_y), fktang_y), ftestnyom_y);
+
+        lanes_store(&forces->wheel_x[k], fkerek_x);
+        lanes_store(&forces->wheel_y[k], fkerek_y);
+        lanes_store(&forces->body_x[k], ftest_x);
+        lanes_store(&forces->body_y[k], ftest_y);
+        lanes_store(&forces->body_torque[k], mtest);
+    }
+}
+
+void bike_batch::step(double time, double dt, const bike_controls* controls) {
+    // Gas and brake, same as the start of leptet()
+    for (int k = 0; k < count; k++) {
+        if (is_dead[k]) {
+            continue;
+        }
+        motorst mot;
+        get(k, &mot);
+        axis_x[k] = cos(mot.bike.rotation);
+        axis_y[k] = sin(mot.bike.rotation);
+        fekgaz(&mot, controls[k].gas, controls[k].brake, &left_torque[k], &right_torque[k]);
+        store(k, mot);
+    }
+
+    spring_forces(left_wheel, LeftWheelDX, LeftWheelDY, left_torque, &left_forces);
+    spring_forces(right_wheel, RightWheelDX, RightWheelDY, right_torque, &right_forces);
+
+    // Volts and movement, same as the rest of leptet()
+    for (int k = 0; k < count; k++) {
+        if (is_dead[k]) {
+            continue;
+        }
+        motorst mot;
+        get(k, &mot);
+
+        motorerok erok;
+        erok.Fkerek2 = vect2(left_forces.wheel_x[k], left_forces.wheel_y[k]);
+        erok.Ftest2 = vect2(left_forces.body_x[k], left_forces.body_y[k]);
+        erok.Mtest2 = left_forces.body_torque[k];
+        erok.Mkerek2 = left_torque[k];
+        erok.Fkerek4 = vect2(right_forces.wheel_x[k], right_forces.wheel_y[k]);
+        erok.Ftest4 = vect2(right_forces.body_x[k], right_forces.body_y[k]);
+        erok.Mtest4 = right_forces.body_torque[k];
+        erok.Mkerek4 = right_torque[k];
+
+        ugraskezeles(&mot, time, controls[k].right_volt, controls[k].left_volt);
+        vect2 i1(axis_x[k], axis_y[k]);
+        mozgatas(wld, &mot, i1, rotate_90deg(i1), erok, dt);
+        szamitfejr(&mot);
+        store(k, mot);
+
+        vect2 point1, point2;
+        if (get_two_anchor_points(wld, mot.head_r, HeadRadius, &point1, &point2)) {
+            is_dead[k] = 1;
+        }
+    }
+
+    wld->events.reset();
+}
@@ -0,0 +1,113 @@
+#ifndef BIKE_BATCH_H
+#define BIKE_BATCH_H
+
+#include <vector>
+
+struct motorst;
+struct rigidbody;
+class world;
+
+// Controls of one bike for one bike_batch::step()
+struct bike_controls {
+    bool gas;
+    bool brake;
+    bool right_volt;
+    bool left_volt;
+};
+
+// One rigidbody of every bike in the batch, one array per field
+struct rigidbody_lanes {
+    std::vector<double> rotation;
+    std::vector<double> angular_velocity;
+    std::vector<double> radius;
+    std::vector<double> mass;
+    std::vector<double> inertia;
+    std::vector<double> rx;
+    std::vector<double> ry;
+    std::vector<double> vx;
+    std::vector<double> vy;
+
+    void resize(int count);
+    void set(int index, const rigidbody& rb);
+    void get(int index, rigidbody* rb) const;
+};
+
+// Wheel spring forces of every bike in the batch for one step (see erokszamitasa() in LEPTET.CPP)
+struct wheel_force_lanes {
+    std::vector<double> wheel_x;
+    std::vector<double> wheel_y;
+    std::vector<double> body_x;
+    std::vector<double> body_y;
+    std::vector<double> body_torque;
+
+    void resize(int count);
+};
+
+// Many independent bikes driven on the same world in lockstep, for route search tools.
+//
+// The bikes are stored as structure of arrays. The wheel spring forces, the bulk of the math in
+// leptet(), are computed two bikes at a time with SSE2 or NEON. Gas, brake, volts and the
+// movement with collision go bike by bike through the same code leptet() uses, so every bike
+// ends up bit for bit where leptet() would have put it.
+//
+// Bikes only collide with the ground: a bike dies when its head touches it and is then left
+// alone. Objects are not checked, and the friction sound is not computed. Bump sounds still go
+// to the world's event buffer, which is cleared after every step.
+class bike_batch {
+    world* wld;
+    int count;
+    // count rounded up to a whole number of SIMD lanes
+    int lane_count;
+
+    rigidbody_lanes bike;
+    rigidbody_lanes left_wheel;
+    rigidbody_lanes right_wheel;
+    std::vector<double> head_x;
+    std::vector<double> head_y;
+    std::vector<int> flipped_bike;
+    std::vector<int> flipped_camera;
+    std::vector<int> gravity_direction;
+    std::vector<double> body_x;
+    std::vector<double> body_y;
+    std::vector<double> body_vx;
+    std::vector<double> body_vy;
+    std::vector<int> apple_count;
+    std::vector<int> prev_brake;
+    std::vector<double> left_wheel_brake_rotation;
+    std::vector<double> right_wheel_brake_rotation;
+    std::vector<int> volting_right;
+    std::vector<int> volting_left;
+    std::vector<double> right_volt_time;
+    std::vector<double> left_volt_time;
+    std::vector<double> angular_velocity_pre_right_volt;
+    std::vector<double> angular_velocity_pre_left_volt;
+    std::vector<char> is_dead;
+
+    // Per step scratch: bike axis, gas/brake torques and the spring forces
+    std::vector<double> axis_x;
+    std::vector<double> axis_y;
+    std::vector<double> left_torque;
+    std::vector<double> right_torque;
+    wheel_force_lanes left_forces;
+    wheel_force_lanes right_forces;
+
+    void store(int index, const motorst& mot);
+    void spring_forces(const rigidbody_lanes& wheel, double wheel_dx, double wheel_dy,
+                       const std::vector<double>& torque, wheel_force_lanes* forces);
+
+  public:
+    // `count` bikes, all copies of wld->motor1
+    bike_batch(world* wld, int count);
+
+    int size() const { return count; }
+    // Replace a bike, reviving it if it was dead
+    void set(int index, const motorst& mot);
+    void get(int index, motorst* mot) const;
+    bool dead(int index) const { return is_dead[index]; }
+
+    // Advance every living bike by `dt` at physics time `time` (leptet()'s `most`).
+    // `controls` has one item per bike.
+    void step(double time, double dt, const bike_controls* controls);
+};
+
+#endif
@@ -85,6 +85,26 @@ void eol_settings::set_turn_time(double t) { turn_time_ = t; }
 
 void eol_settings::set_lctrl_search(bool lctrl_search) { lctrl_search_ = lctrl_search; }
 
+void eol_settings::set_threaded_present(bool b) { threaded_present_ = b; }
+
+void eol_settings::set_render_threads(int n) { render_threads_ = n; }
+
+void eol_settings::set_dynamic_resolution(bool b) { dynamic_resolution_ = b; }
+
+void eol_settings::set_render_divisor(int d) {
+    if (d != render_divisor_) {
+        render_divisor_ = d;
+        set_zoom_factor();
+        invalidate_lgr_cache();
+    }
+}
+
+void eol_settings::set_fixed_timestep(bool b) { fixed_timestep_ = b; }
+
+void eol_settings::set_extended_levels(bool b) { extended_levels_ = b; }
+
+void eol_settings::set_compress_replays(bool b) { compress_replays_ = b; }
+
 void eol_settings::set_alovolt_key_player_a(DikScancode key) { alovolt_key_player_a_ = key; }
 
 void eol_settings::set_alovolt_key_player_b(DikScancode key) { alovolt_key_player_b_ = key; }
@@ -111,6 +131,12 @@ void eol_settings::set_replay_slow_4x_key(DikScancode key) { replay_slow_4x_key_
 
 void eol_settings::set_replay_pause_key(DikScancode key) { replay_pause_key_ = key; }
 
+void eol_settings::set_replay_rewind_key(DikScancode key) { replay_rewind_key_ = key; }
+
+void eol_settings::set_replay_skip_back_key(DikScancode key) { replay_skip_back_key_ = key; }
+
+void eol_settings::set_replay_skip_forward_key(DikScancode key) { replay_skip_forward_key_ = key; }
+
 /*
  * This uses the nlohmann json library to (de)serialise `eol_settings` to json.
  *
@@ -188,6 +214,13 @@ void from_json(const json& j, RendererType& r) {
     JSON_FIELD(renderer)                                                                           \
     JSON_FIELD(turn_time)                                                                          \
     JSON_FIELD(lctrl_search)                                                                       \
+    JSON_FIELD(threaded_present)                                                                   \
+    JSON_FIELD(render_threads)                                                                     \
+    JSON_FIELD(dynamic_resolution)                                                                 \
+    JSON_FIELD(render_divisor)                                                                     \
+    JSON_FIELD(fixed_timestep)                                                                     \
+    JSON_FIELD(extended_levels)                                                                    \
+    JSON_FIELD(compress_replays)                                                                   \
     JSON_FIELD(alovolt_key_player_a)                                                               \
     JSON_FIELD(alovolt_key_player_b)                                                               \
     JSON_FIELD(brake_alias_key_player_a)                                                           \
@@ -198,7 +231,10 @@ void from_json(const json& j, RendererType& r) {
     JSON_FIELD(replay_fast_8x_key)                                                                 \
     JSON_FIELD(replay_slow_2x_key)                                                                 \
     JSON_FIELD(replay_slow_4x_key)                                                                 \
-    JSON_FIELD(replay_pause_key)
+    JSON_FIELD(replay_pause_key)                                                                   \
+    JSON_FIELD(replay_rewind_key)                                                                  \
+    JSON_FIELD(replay_skip_back_key)                                                               \
+    JSON_FIELD(replay_skip_forward_key)
 
 #define JSON_FIELD(name) {#name, s.name()},
 void to_json(json& j, const eol_settings& s) { j = json{FIELD_LIST}; }
@@ -254,6 +290,9 @@ void eol_settings::sync_controls_to_state(state* s) {
     s->key_replay_slow_2x = EolSettings->replay_slow_2x_key();
     s->key_replay_slow_4x = EolSettings->replay_slow_4x_key();
     s->key_replay_pause = EolSettings->replay_pause_key();
+    s->key_replay_rewind = EolSettings->replay_rewind_key();
+    s->key_replay_skip_back = EolSettings->replay_skip_back_key();
+    s->key_replay_skip_forward = EolSettings->replay_skip_forward_key();
 }
 
 void eol_settings::sync_controls_from_state(state* s) {
@@ -272,4 +311,7 @@ void eol_settings::sync_controls_from_state(state* s) {
     EolSettings->set_replay_slow_2x_key(s->key_replay_slow_2x);
     EolSettings->set_replay_slow_4x_key(s->key_replay_slow_4x);
     EolSettings->set_replay_pause_key(s->key_replay_pause);
+    EolSettings->set_replay_rewind_key(s->key_replay_rewind);
+    EolSettings->set_replay_skip_back_key(s->key_replay_skip_back);
+    EolSettings->set_replay_skip_forward_key(s->key_replay_skip_forward);
 }
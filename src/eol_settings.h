@@ -63,6 +63,15 @@ class eol_settings {
     Default<bool> zoom_textures_{false};
     Clamp<double> turn_time_{0.0, 0.35, 0.35};
     Default<bool> lctrl_search_{false};
+    Default<bool> threaded_present_{false};
+    Clamp<int> render_threads_{1, 1, 8};
+    Default<bool> dynamic_resolution_{false};
+    Clamp<int> render_divisor_{1, 1, 4};
+    Default<bool> fixed_timestep_{false};
+    // Load levels beyond the limits of the original game, see level.h
+    Default<bool> extended_levels_{false};
+    // Save replays in the compressed format, which the original game cannot read, see recorder.cpp
+    Default<bool> compress_replays_{false};
     Default<DikScancode> alovolt_key_player_a_{DIK_UNKNOWN};
     Default<DikScancode> alovolt_key_player_b_{DIK_UNKNOWN};
     Default<DikScancode> brake_alias_key_player_a_{DIK_UNKNOWN};
@@ -74,6 +83,9 @@ class eol_settings {
     Default<DikScancode> replay_slow_2x_key_{DIK_DOWN};
     Default<DikScancode> replay_slow_4x_key_{DIK_NEXT};
     Default<DikScancode> replay_pause_key_{DIK_SPACE};
+    Default<DikScancode> replay_rewind_key_{DIK_LEFT};
+    Default<DikScancode> replay_skip_back_key_{DIK_COMMA};
+    Default<DikScancode> replay_skip_forward_key_{DIK_PERIOD};
 
   public:
     static void read_settings();
@@ -92,6 +104,13 @@ class eol_settings {
     DECLARE_FIELD_FUNCS(zoom_textures);
     DECLARE_FIELD_FUNCS(turn_time);
     DECLARE_FIELD_FUNCS(lctrl_search);
+    DECLARE_FIELD_FUNCS(threaded_present);
+    DECLARE_FIELD_FUNCS(render_threads);
+    DECLARE_FIELD_FUNCS(dynamic_resolution);
+    DECLARE_FIELD_FUNCS(render_divisor);
+    DECLARE_FIELD_FUNCS(fixed_timestep);
+    DECLARE_FIELD_FUNCS(extended_levels);
+    DECLARE_FIELD_FUNCS(compress_replays);
     DECLARE_FIELD_FUNCS(alovolt_key_player_a);
     DECLARE_FIELD_FUNCS(alovolt_key_player_b);
     DECLARE_FIELD_FUNCS(brake_alias_key_player_a);
@@ -103,6 +122,9 @@ class eol_settings {
     DECLARE_FIELD_FUNCS(replay_slow_2x_key);
     DECLARE_FIELD_FUNCS(replay_slow_4x_key);
     DECLARE_FIELD_FUNCS(replay_pause_key);
+    DECLARE_FIELD_FUNCS(replay_rewind_key);
+    DECLARE_FIELD_FUNCS(replay_skip_back_key);
+    DECLARE_FIELD_FUNCS(replay_skip_forward_key);
 };
 
 #undef DECLARE_FIELD_FUNCS
@@ -0,0 +1,507 @@
+// export_video: renders a replay through lejatszo_r()/kirajzol320() on the headless platform at a
+// fixed frame rate, as fast as the machine allows, and writes the frames as a Y4M or raw RGB24
+// stream or as numbered PPM images.
+//
+// make TARGET=headless export_video
+// build-headless/export_video [--fps <n>] [--jobs <n>] [--threads <n>] [--workers <n>] [--demo]
+//                             (--y4m <file> | --raw <file> | --images <dir>) file.rec
+//
+// A <file> of "-" is stdout, for piping into an encoder:
+// build-headless/export_video --y4m - 01mopo.rec | ffmpeg -i - 01mopo.mp4
+//
+// The game renderer keeps its state in globals, so frames are drawn by --jobs forked processes
+// (default: one per core), each with its own framebuffer and renderer state. Job i draws the
+// frames i, i + jobs, ..., and plays the others without drawing them, so every frame comes out as
+// a single process would draw it. Each job can split its frames across --threads render threads
+// (default 1 with several jobs). Converting and writing the frames runs on --workers threads
+// (default 2), each with its own output buffer.
+
+#include "eol_settings.h"
+#include "headless_game.h"
+#include "LEJATSZO.H"
+#include "main.h"
+#include "M_PIC.H"
+#include "platform_headless.h"
+#include "recorder.h"
+#include "timer.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+enum class OutputFormat { Y4m, Raw, Images };
+
+// One presented frame waiting to be converted
+struct frame_job {
+    long long index;
+    std::vector<unsigned char> pixels;
+    unsigned char palette_rgb[768];
+};
+
+class frame_exporter {
+    OutputFormat format;
+    FILE* out;
+    std::string directory;
+    int width;
+    int height;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<frame_job> jobs;
+    std::vector<frame_job*> free_jobs;
+    std::deque<frame_job*> queued_jobs;
+    long long next_index;
+    // Streams are written in frame order
+    long long next_write;
+    bool stopping;
+    bool failed;
+    std::vector<std::thread> workers;
+
+    void encode(const frame_job& job, std::vector<unsigned char>* encoded) const;
+    bool write(const frame_job& job, const std::vector<unsigned char>& encoded);
+    void worker_main();
+
+  public:
+    frame_exporter(OutputFormat output_format, FILE* output, const std::string& output_directory,
+                   int frame_width, int frame_height, int worker_count);
+    // Copies the frame and returns, unless all frame buffers are still being converted
+    void submit(const unsigned char* pixels, const unsigned char* palette_rgb);
+    // Waits for all submitted frames, return false if writing failed
+    bool finish();
+    long long frame_count() const { return next_index; }
+};
+
+frame_exporter::frame_exporter(OutputFormat output_format, FILE* output,
+                               const std::string& output_directory, int frame_width,
+                               int frame_height, int worker_count) {
+    format = output_format;
+    out = output;
+    directory = output_directory;
+    width = frame_width;
+    height = frame_height;
+    next_index = 0;
+    next_write = 0;
+    stopping = false;
+    failed = false;
+
+    // Two frames per worker, so the renderer rarely waits
+    jobs.resize(worker_count * 2);
+    for (frame_job& job : jobs) {
+        job.pixels.resize(width * height);
+        free_jobs.push_back(&job);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        workers.emplace_back(&frame_exporter::worker_main, this);
+    }
+}
+
+// BT.601 studio range, what Y4M readers assume
+static void palette_to_yuv(const unsigned char* palette_rgb, int* y, int* u, int* v) {
+    for (int i = 0; i < 256; i++) {
+        int r = palette_rgb[i * 3];
+        int g = palette_rgb[i * 3 + 1];
+        int b = palette_rgb[i * 3 + 2];
+        y[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        u[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+        v[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    }
+}
+
+void frame_exporter::encode(const frame_job& job, std::vector<unsigned char>* encoded) const {
+    encoded->clear();
+    const unsigned char* pixels = job.pixels.data();
+    if (format == OutputFormat::Y4m) {
+        int y[256];
+        int u[256];
+        int v[256];
+        palette_to_yuv(job.palette_rgb, y, u, v);
+
+        static const char FRAME_HEADER[] = "FRAME\n";
+        int chroma_width = width / 2;
+        int chroma_height = height / 2;
+        int chroma_size = chroma_width * chroma_height;
+        encoded->resize(sizeof(FRAME_HEADER) - 1 + width * height + 2 * chroma_size);
+        unsigned char* dest = encoded->data();
+        memcpy(dest, FRAME_HEADER, sizeof(FRAME_HEADER) - 1);
+        dest += sizeof(FRAME_HEADER) - 1;
+        for (int i = 0; i < width * height; i++) {
+            dest[i] = y[pixels[i]];
+        }
+        // 4:2:0, chroma averaged over each 2x2 block
+        unsigned char* dest_u = dest + width * height;
+        unsigned char* dest_v = dest_u + chroma_size;
+        for (int cy = 0; cy < chroma_height; cy++) {
+            const unsigned char* row1 = pixels + cy * 2 * width;
+            const unsigned char* row2 = row1 + width;
+            for (int cx = 0; cx < chroma_width; cx++) {
+                int a = row1[cx * 2];
+                int b = row1[cx * 2 + 1];
+                int c = row2[cx * 2];
+                int d = row2[cx * 2 + 1];
+                dest_u[cy * chroma_width + cx] = (u[a] + u[b] + u[c] + u[d] + 2) >> 2;
+                dest_v[cy * chroma_width + cx] = (v[a] + v[b] + v[c] + v[d] + 2) >> 2;
+            }
+        }
+        return;
+    }
+
+    char header[40] = "";
+    if (format == OutputFormat::Images) {
+        snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    }
+    size_t header_length = strlen(header);
+    encoded->resize(header_length + width * height * 3);
+    unsigned char* dest = encoded->data();
+    memcpy(dest, header, header_length);
+    dest += header_length;
+    for (int i = 0; i < width * height; i++) {
+        memcpy(dest + i * 3, &job.palette_rgb[pixels[i] * 3], 3);
+    }
+}
+
+bool frame_exporter::write(const frame_job& job, const std::vector<unsigned char>& encoded) {
+    if (format == OutputFormat::Images) {
+        char filename[32];
+        snprintf(filename, sizeof(filename), "frame_%06lld.ppm", job.index + 1);
+        std::string path = directory + "/" + filename;
+        FILE* h = fopen(path.c_str(), "wb");
+        if (!h) {
+            return false;
+        }
+        bool ok = fwrite(encoded.data(), 1, encoded.size(), h) == encoded.size();
+        return fclose(h) == 0 && ok;
+    }
+    return fwrite(encoded.data(), 1, encoded.size(), out) == encoded.size();
+}
+
+void frame_exporter::worker_main() {
+    std::vector<unsigned char> encoded;
+    while (true) {
+        frame_job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || !queued_jobs.empty(); });
+            if (queued_jobs.empty()) {
+                return;
+            }
+            job = queued_jobs.front();
+            queued_jobs.pop_front();
+        }
+
+        encode(*job, &encoded);
+
+        bool ok = true;
+        if (format == OutputFormat::Images) {
+            ok = write(*job, encoded);
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (format != OutputFormat::Images) {
+                changed.wait(lock, [this, job] { return next_write == job->index; });
+                // After a failed write the remaining frames are only drained
+                ok = failed || write(*job, encoded);
+                next_write++;
+            }
+            if (!ok) {
+                failed = true;
+            }
+            free_jobs.push_back(job);
+        }
+        changed.notify_all();
+    }
+}
+
+void frame_exporter::submit(const unsigned char* pixels, const unsigned char* palette_rgb) {
+    frame_job* job = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return !free_jobs.empty(); });
+        job = free_jobs.back();
+        free_jobs.pop_back();
+    }
+
+    memcpy(job->pixels.data(), pixels, width * height);
+    memcpy(job->palette_rgb, palette_rgb, sizeof(job->palette_rgb));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job->index = next_index++;
+        queued_jobs.push_back(job);
+    }
+    changed.notify_all();
+}
+
+bool frame_exporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    if (out && fflush(out) != 0) {
+        failed = true;
+    }
+    return !failed;
+}
+
+// Renderer processes (--jobs) are forks of this one, each with its own framebuffer and renderer
+// state. Every job plays the whole replay but draws only every JobCount-th frame, and sends those
+// through its pipe as the indexed pixels followed by the palette.
+static int JobIndex = 0;
+static int JobCount = 1;
+static int JobPipe = -1;
+// Replay time between two frames
+static double FrameTime = 0.0;
+// Set while the frame being played is one of this job's
+static bool FrameDue = false;
+
+static double job_frame_time(long frame, bool* draw) {
+    *draw = frame % JobCount == JobIndex;
+    FrameDue = *draw;
+    return frame * FrameTime;
+}
+
+static bool write_all(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Returns the number of bytes read, less than `size` only at the end of the pipe
+static size_t read_all(int fd, unsigned char* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t got = read(fd, data + total, size - total);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        total += got;
+    }
+    return total;
+}
+
+static void job_present(const unsigned char* pixels, int width, int height,
+                        const unsigned char* palette_rgb) {
+    if (!FrameDue) {
+        return;
+    }
+    FrameDue = false;
+    if (!write_all(JobPipe, pixels, width * height) || !write_all(JobPipe, palette_rgb, 768)) {
+        _exit(1);
+    }
+}
+
+// Runs in the forked job process and does not return
+static void run_job(int index, int count, int pipe_fd) {
+    JobIndex = index;
+    JobCount = count;
+    JobPipe = pipe_fd;
+    Replayido = job_frame_time;
+    headless_set_present_hook(job_present);
+    lejatszo_r(Rec1->level_filename, 0);
+    close(pipe_fd);
+    _exit(0);
+}
+
+static int usage() {
+    fprintf(stderr,
+            "Usage: export_video [--fps <n>] [--jobs <n>] [--threads <n>] [--workers <n>]\n"
+            "                    [--demo] (--y4m <file> | --raw <file> | --images <dir>) file.rec\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    int fps = 30;
+    int job_count = std::max(1, (int)std::thread::hardware_concurrency());
+    int threads = 0;
+    int worker_count = 2;
+    bool demo = false;
+    OutputFormat format = OutputFormat::Y4m;
+    std::string output;
+    std::string rec_filename;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            job_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            worker_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        } else if (strcmp(argv[i], "--y4m") == 0 && i + 1 < argc) {
+            format = OutputFormat::Y4m;
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc) {
+            format = OutputFormat::Raw;
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--images") == 0 && i + 1 < argc) {
+            format = OutputFormat::Images;
+            output = argv[++i];
+        } else if (argv[i][0] != '-' && rec_filename.empty()) {
+            rec_filename = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if (output.empty() || rec_filename.empty() || fps < 1 || job_count < 1 || worker_count < 1) {
+        return usage();
+    }
+
+    // The game may print to stdout while rendering, keep the stream clean by sending that to
+    // stderr
+    FILE* out = nullptr;
+    if (output == "-" && format != OutputFormat::Images) {
+        fflush(stdout);
+        out = fdopen(dup(STDOUT_FILENO), "wb");
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
+
+    headless_game_init();
+    if (threads > 0) {
+        EolSettings->set_render_threads(threads);
+    } else if (job_count > 1) {
+        // The jobs already keep the cores busy
+        EolSettings->set_render_threads(1);
+    }
+    // Frames must not depend on how fast they were drawn
+    EolSettings->set_dynamic_resolution(false);
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    if (format == OutputFormat::Y4m && (width % 2 || height % 2)) {
+        fprintf(stderr, "Y4M output needs an even screen size, not %dx%d\n", width, height);
+        return 1;
+    }
+
+    if (!headless_load_replay({rec_filename, demo})) {
+        return 1;
+    }
+
+    if (format == OutputFormat::Images) {
+        std::error_code error;
+        std::filesystem::create_directories(output, error);
+        if (error) {
+            fprintf(stderr, "Cannot create %s\n", output.c_str());
+            return 1;
+        }
+    } else if (!out) {
+        out = fopen(output.c_str(), "wb");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s for writing\n", output.c_str());
+            return 1;
+        }
+    }
+    if (format == OutputFormat::Y4m) {
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FrameTime = 100.0 / TimeToCentiseconds / fps;
+    headless_set_frame_step(1000.0 / fps);
+    size_t frame_bytes = width * height + 768;
+
+    // Fork before any thread is started. Nothing buffered may be left for the jobs to flush.
+    fflush(nullptr);
+    std::vector<pid_t> jobs;
+    std::vector<int> pipes;
+    for (int i = 0; i < job_count; i++) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            fprintf(stderr, "Cannot create a pipe for job %d\n", i);
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            fprintf(stderr, "Cannot start job %d\n", i);
+            return 1;
+        }
+        if (pid == 0) {
+            for (int fd : pipes) {
+                close(fd);
+            }
+            close(fds[0]);
+            run_job(i, job_count, fds[1]);
+        }
+        close(fds[1]);
+#ifdef F_SETPIPE_SZ
+        // Room for a whole frame, so a job can draw its next one while waiting for its turn
+        fcntl(fds[0], F_SETPIPE_SZ, (int)frame_bytes);
+#endif
+        jobs.push_back(pid);
+        pipes.push_back(fds[0]);
+    }
+
+    frame_exporter exporter(format, out, output, width, height, worker_count);
+    std::vector<unsigned char> frame(frame_bytes);
+    bool complete = true;
+    for (long long index = 0;; index++) {
+        size_t got = read_all(pipes[index % job_count], frame.data(), frame_bytes);
+        if (got == 0) {
+            // The replay has ended
+            break;
+        }
+        if (got != frame_bytes) {
+            complete = false;
+            break;
+        }
+        exporter.submit(frame.data(), frame.data() + width * height);
+    }
+    for (int fd : pipes) {
+        close(fd);
+    }
+    // Jobs end on the same frame, one that crashed or was cut short fails the export
+    for (pid_t pid : jobs) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            complete = false;
+        }
+    }
+
+    bool ok = exporter.finish();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+    if (out) {
+        fclose(out);
+    }
+    if (!complete) {
+        fprintf(stderr, "A render job failed, %s is incomplete\n", output.c_str());
+        return 1;
+    }
+    if (!ok) {
+        fprintf(stderr, "Failed to write %s\n", output.c_str());
+        return 1;
+    }
+
+    long long frames = exporter.frame_count();
+    fprintf(stderr, "%lld frames (%.2f s at %d fps) in %.2f s, %.1f times real time\n", frames,
+            (double)frames / fps, fps, seconds, frames / (double)fps / seconds);
+    return 0;
+}
@@ -73,3 +73,23 @@ void flagtag_replay(double time) {
 
     FlagTagElapsedTime = time;
 }
+
+flagtag_state flagtag_save() {
+    flagtag_state state;
+    state.a_has_flag = FlagTagAHasFlag;
+    state.immunity = FlagTagImmunity;
+    state.a_starts = FlagTagAStarts;
+    state.time_a = FlagTimeA;
+    state.time_b = FlagTimeB;
+    state.elapsed_time = FlagTagElapsedTime;
+    return state;
+}
+
+void flagtag_restore(const flagtag_state& state) {
+    FlagTagAHasFlag = state.a_has_flag;
+    FlagTagImmunity = state.immunity;
+    FlagTagAStarts = state.a_starts;
+    FlagTimeA = state.time_a;
+    FlagTimeB = state.time_b;
+    FlagTagElapsedTime = state.elapsed_time;
+}
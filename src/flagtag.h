@@ -7,8 +7,21 @@ extern bool FlagTagAStarts;
 extern double FlagTimeA;
 extern double FlagTimeB;
 
+// Everything flagtag() keeps between frames
+struct flagtag_state {
+    bool a_has_flag;
+    bool immunity;
+    bool a_starts;
+    double time_a;
+    double time_b;
+    double elapsed_time;
+};
+
 void flagtag_reset();
 void flagtag(double time);
 void flagtag_replay(double time);
 
+flagtag_state flagtag_save();
+void flagtag_restore(const flagtag_state& state);
+
 #endif
@@ -0,0 +1,95 @@
+#include "headless_game.h"
+#include "abc8.h"
+#include "EDITUJ.H"
+#include "eol_settings.h"
+#include "fs_utils.h"
+#include "KIRAJZOL.H"
+#include "level.h"
+#include "LOAD.H"
+#include "M_PIC.H"
+#include "menu_pic.h"
+#include "physics_init.h"
+#include "platform_impl.h"
+#include "qopen.h"
+#include "recorder.h"
+#include "state.h"
+#include <cstdio>
+
+void headless_game_init() {
+    EolSettings = new eol_settings();
+    eol_settings::read_settings();
+
+    SCREEN_WIDTH = EolSettings->screen_width();
+    SCREEN_HEIGHT = EolSettings->screen_height();
+
+    platform_init();
+
+    // Same as menu_intro(), minus the intro screen and the menus:
+    init_qopen();
+
+    init_menu_pictures();
+
+    State = new state;
+    merge_states();
+    eol_settings::sync_controls_to_state(State);
+    init_shirt();
+
+    init_physics_data();
+
+    init_sound();
+
+    Pabc1 = new abc8("kisbetu1.abc");
+    Pabc1->set_spacing(1);
+    Pabc2 = new abc8("kisbetu2.abc");
+    Pabc2->set_spacing(1);
+
+    Rec1 = new recorder;
+    Rec2 = new recorder;
+
+    seteditorpal();
+}
+
+std::vector<replay_file> headless_replay_files() {
+    std::vector<replay_file> files;
+
+    finame filename;
+    bool done = find_first("rec/*.rec", filename);
+    while (!done) {
+        files.push_back({filename, false});
+        done = find_next(filename);
+    }
+    find_close();
+
+    // Same list as demo() in MAINMENU.CPP
+    files.push_back({"demor1.rec", true});
+    files.push_back({"demor2.rec", true});
+    files.push_back({"demor3.rec", true});
+
+    return files;
+}
+
+bool headless_load_replay(const replay_file& rec) {
+    int level_id = 0;
+    if (!recorder::load_rec_file(rec.filename.c_str(), rec.demo, &level_id)) {
+        printf("%s: damaged replay file, skipped\n", rec.filename.c_str());
+        return false;
+    }
+    if (access_level_file(Rec1->level_filename) != 0) {
+        printf("%s: cannot find level %s, skipped\n", rec.filename.c_str(), Rec1->level_filename);
+        return false;
+    }
+    if (!floadlevel_p(Rec1->level_filename)) {
+        printf("%s: level %s has topology errors, skipped\n", rec.filename.c_str(),
+               Rec1->level_filename);
+        return false;
+    }
+    if (Ptop->level_id != level_id) {
+        printf("%s: level %s has changed since recording, skipped\n", rec.filename.c_str(),
+               Rec1->level_filename);
+        return false;
+    }
+
+    Rec1->rewind();
+    Rec2->rewind();
+    return true;
+}
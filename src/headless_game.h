@@ -0,0 +1,24 @@
+#ifndef HEADLESS_GAME_H
+#define HEADLESS_GAME_H
+
+#include <string>
+#include <vector>
+
+// Shared setup for the headless tools (bench_render, ...), built with make TARGET=headless.
+
+// Reads settings and loads everything menu_intro() would, without showing any menu
+void headless_game_init();
+
+struct replay_file {
+    std::string filename;
+    bool demo; // Built-in demo from elma.res instead of rec/
+};
+
+// Every rec/*.rec file followed by the built-in demos
+std::vector<replay_file> headless_replay_files();
+
+// Loads a replay and its level into Rec1, Rec2 and Ptop, rewound and ready for lejatszo_r().
+// Prints the reason and returns false if the level is missing or has changed.
+bool headless_load_replay(const replay_file& rec);
+
+#endif
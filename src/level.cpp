@@ -3,6 +3,7 @@
 #include "ED_CHECK.H"
 #include "editor_canvas.h"
 #include "editor_dialog.h"
+#include "eol_settings.h"
 #include "EDITTOLT.H"
 #include "EDITUJ.H"
 #include "polygon.h"
@@ -38,6 +39,18 @@ static char InternalFilePaths[STATE_LEVEL_COUNT + 2][14] = {
 
 static char FgetsBuffer[110];
 
+int max_polygons() {
+    return EolSettings->extended_levels() ? MAX_POLYGONS_EXTENDED : MAX_POLYGONS;
+}
+
+int max_vertices() {
+    return EolSettings->extended_levels() ? MAX_VERTICES_EXTENDED : MAX_VERTICES;
+}
+
+int max_sprites() {
+    return EolSettings->extended_levels() ? MAX_SPRITES_EXTENDED : MAX_SPRITES;
+}
+
 const char* get_internal_level_name(int index) {
     constexpr int INTERNAL_MAX_NAME_LENGTH = 30;
     static char InternalLevelNames[INTERNAL_LEVEL_COUNT][INTERNAL_MAX_NAME_LENGTH + 2] = {};
@@ -83,20 +96,11 @@ level::level() {
     objects_flipped = false;
     topology_errors = false;
     topten_file_offset = 0;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
-        polygons[i] = nullptr;
-    }
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        objects[i] = nullptr;
-    }
-    for (int i = 0; i < MAX_SPRITES; i++) {
-        sprites[i] = nullptr;
-    }
     memset(&toptens, 0, sizeof(toptens));
 
-    polygons[0] = new polygon;
-    objects[0] = new object(-2.0, 0.5, object::Type::Exit);
-    objects[1] = new object(2.0, 0.5, object::Type::Start);
+    polygons.push_back(new polygon);
+    objects.push_back(new object(-2.0, 0.5, object::Type::Exit));
+    objects.push_back(new object(2.0, 0.5, object::Type::Start));
     strcpy(level_name, "Unnamed");
     strcpy(lgr_name, "default");
     strcpy(foreground_name, "ground");
@@ -104,29 +108,29 @@ level::level() {
 }
 
 level::~level() {
-    for (int i = 0; i < MAX_POLYGONS; i++) {
-        if (polygons[i]) {
-            delete polygons[i];
+    for (polygon* poly : polygons) {
+        if (poly) {
+            delete poly;
         }
-        polygons[i] = nullptr;
     }
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        if (objects[i]) {
-            delete objects[i];
+    polygons.clear();
+    for (object* obj : objects) {
+        if (obj) {
+            delete obj;
         }
-        objects[i] = nullptr;
     }
-    for (int i = 0; i < MAX_SPRITES; i++) {
-        if (sprites[i]) {
-            delete sprites[i];
+    objects.clear();
+    for (sprite* spr : sprites) {
+        if (spr) {
+            delete spr;
         }
-        sprites[i] = nullptr;
     }
+    sprites.clear();
 }
 
 bool level::discard_missing_lgr_assets(lgrfile* lgr) {
     bool sprites_deleted = false;
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         if (!sprites[i]) {
             continue;
         }
@@ -179,17 +183,8 @@ bool level::discard_missing_lgr_assets(lgrfile* lgr) {
         }
     }
 
-    bool sprites_shifted = true;
-    while (sprites_shifted) {
-        sprites_shifted = false;
-        for (int i = 0; i < MAX_SPRITES - 1; i++) {
-            if (!sprites[i] && sprites[i + 1]) {
-                sprites[i] = sprites[i + 1];
-                sprites[i + 1] = nullptr;
-                sprites_shifted = true;
-            }
-        }
-    }
+    // Close the gaps, keeping the order
+    sprites.erase(std::remove(sprites.begin(), sprites.end(), nullptr), sprites.end());
 
     // Disallow identical foreground/background textures
     if (strcmpi(foreground_name, background_name) == 0) {
@@ -237,7 +232,7 @@ polygon* level::get_closest_vertex(double x, double y, int* vertex_index, double
     }
     double closest_distance = 1000000.0;
     polygon* poly = nullptr;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (!polygons[i]) {
             continue;
         }
@@ -283,7 +278,7 @@ object* level::get_closest_object(double x, double y, double* distance) {
     double closest_distance = 1000000.0;
     object* obj = nullptr;
     vect2 r(x, y);
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         if (objects[i]) {
             double new_distance = (objects[i]->r - r).length();
             if (new_distance < closest_distance) {
@@ -311,7 +306,7 @@ sprite* level::get_closest_sprite(double x, double y, double* distance) {
     double closest_distance = 1000000.0;
     sprite* spr = nullptr;
     vect2 r(x, y);
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         // Skip all sprites if they aren't rendered in editor
         if (!Rajzolkepek) {
             continue;
@@ -340,7 +335,7 @@ sprite* level::get_closest_sprite(double x, double y, double* distance) {
 }
 
 void level::render() {
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i]) {
             if (polygons[i]->is_grass) {
                 if (Rajzolkoveto) {
@@ -354,13 +349,13 @@ void level::render() {
         }
     }
 
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         if (objects[i]) {
             objects[i]->render();
         }
     }
 
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         if (sprites[i]) {
             if (Rajzolkepek) {
                 sprites[i]->render();
@@ -385,7 +380,7 @@ bool level::is_sky(polygon* poly, vect2* point) {
     // See how many times a line drawn from here to outside of the map will intersect
     vect2 v = vect2(27654.475374565578, 37850.5364775); // Possible polarity inversion bug here
     int intersections = 0;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i] && !polygons[i]->is_grass && polygons[i] != poly) {
             intersections += polygons[i]->count_intersections(r, v);
         }
@@ -601,15 +596,9 @@ void level::from_file(const char* filename, bool internal) {
     topology_errors = false;
     topten_file_offset = 0;
     memset(&toptens, 0, sizeof(toptens));
-    for (int i = 0; i < MAX_POLYGONS; i++) {
-        polygons[i] = nullptr;
-    }
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        objects[i] = nullptr;
-    }
-    for (int i = 0; i < MAX_SPRITES; i++) {
-        sprites[i] = nullptr;
-    }
+    polygons.clear();
+    objects.clear();
+    sprites.clear();
 
     FILE* h = nullptr;
     if (internal) {
@@ -748,7 +737,7 @@ void level::from_file(const char* filename, bool internal) {
     }
 
     int polygon_count = (int)(encrypted_polygon_count);
-    if (polygon_count > MAX_POLYGONS) {
+    if (polygon_count > max_polygons()) {
         external_error("Too many polygons in level file!", filename);
     }
 
@@ -757,7 +746,7 @@ void level::from_file(const char* filename, bool internal) {
     }
 
     for (int i = 0; i < polygon_count; i++) {
-        polygons[i] = new polygon(h, version);
+        polygons.push_back(new polygon(h, version));
     }
 
     if (!internal) {
@@ -767,14 +756,14 @@ void level::from_file(const char* filename, bool internal) {
     }
 
     int object_count = (int)(encrypted_object_count);
-    if (object_count > MAX_OBJECTS) {
+    if (object_count > MAX_LOADED_OBJECTS) {
         external_error("Too many objects in level file!", filename);
     }
     if (object_count <= 0) {
         external_error("Corrupt .LEV file!", filename);
     }
     for (int i = 0; i < object_count; i++) {
-        objects[i] = new object(h, version);
+        objects.push_back(new object(h, version));
     }
 
     if (version == 14) {
@@ -783,14 +772,14 @@ void level::from_file(const char* filename, bool internal) {
             external_error("Error reading level file!", filename);
         }
         int sprite_count = (int)(encrypted_sprite_count);
-        if (sprite_count > MAX_SPRITES) {
+        if (sprite_count > max_sprites()) {
             external_error("Too many pictures in level file!", filename);
         }
         if (sprite_count < 0) {
             external_error("Corrupt .LEV file!", filename);
         }
         for (int i = 0; i < sprite_count; i++) {
-            sprites[i] = new sprite(h);
+            sprites.push_back(new sprite(h));
         }
     }
 
@@ -929,7 +918,7 @@ void level::save(const char* filename, bool skip_topology) {
     fwrite(background_name, 1, 10, h);
 
     int polygon_count = 0;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i]) {
             polygon_count++;
         }
@@ -937,7 +926,7 @@ void level::save(const char* filename, bool skip_topology) {
     double polygon_count_encrypted = polygon_count + 0.4643643;
 
     int object_count = 0;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         if (objects[i]) {
             object_count++;
         }
@@ -949,7 +938,7 @@ void level::save(const char* filename, bool skip_topology) {
         // object_count is moved out of order in .leb files.
         fwrite(&object_count_encrypted, 1, sizeof(object_count_encrypted), h);
     }
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i]) {
             polygons[i]->save(h, this);
         }
@@ -958,14 +947,14 @@ void level::save(const char* filename, bool skip_topology) {
     if (!SAVE_INTERNAL) {
         fwrite(&object_count_encrypted, 1, sizeof(object_count_encrypted), h);
     }
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         if (objects[i]) {
             objects[i]->save(h);
         }
     }
 
     int sprite_count = 0;
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         if (sprites[i]) {
             sprite_count++;
         }
@@ -973,7 +962,7 @@ void level::save(const char* filename, bool skip_topology) {
 
     double sprite_count_encrypted = sprite_count + 0.2345672;
     fwrite(&sprite_count_encrypted, 1, sizeof(sprite_count_encrypted), h);
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         if (sprites[i]) {
             sprites[i]->save(h);
         }
@@ -1039,13 +1028,13 @@ void level::get_boundaries(double* x1, double* y1, double* x2, double* y2,
     *y1 = 100000000000.0;
     *x2 = -100000000000.0;
     *y2 = -100000000000.0;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i]) {
             polygons[i]->update_boundaries(x1, y1, x2, y2);
         }
     }
     if (check_objects_and_sprites) {
-        for (int i = 0; i < MAX_OBJECTS; i++) {
+        for (int i = 0; i < (int)objects.size(); i++) {
             if (objects[i]) {
                 if (*x1 > objects[i]->r.x) {
                     *x1 = objects[i]->r.x;
@@ -1061,7 +1050,7 @@ void level::get_boundaries(double* x1, double* y1, double* x2, double* y2,
                 }
             }
         }
-        for (int i = 0; i < MAX_SPRITES; i++) {
+        for (int i = 0; i < (int)sprites.size(); i++) {
             if (sprites[i]) {
                 if (*x1 > sprites[i]->r.x) {
                     *x1 = sprites[i]->r.x;
@@ -1082,17 +1071,17 @@ void level::get_boundaries(double* x1, double* y1, double* x2, double* y2,
 
 double level::checksum() {
     double sum = 0.0;
-    for (int i = 0; i < MAX_POLYGONS; i++) {
+    for (int i = 0; i < (int)polygons.size(); i++) {
         if (polygons[i]) {
             sum += polygons[i]->checksum();
         }
     }
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         if (objects[i]) {
             sum += objects[i]->checksum();
         }
     }
-    for (int i = 0; i < MAX_SPRITES; i++) {
+    for (int i = 0; i < (int)sprites.size(); i++) {
         if (sprites[i]) {
             sum += sprites[i]->checksum();
         }
@@ -1102,12 +1091,12 @@ double level::checksum() {
     return CHECKSUM_MULTIPLIER * sum;
 }
 
-vect2 BikeStartOffset;
+thread_local vect2 BikeStartOffset;
 
 int level::initialize_objects(motorst* mot) {
     int apple_count = 0;
     bool start_found = false;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         object* obj = objects[i];
         if (obj) {
             // Set a random phase to every object
@@ -1157,7 +1146,7 @@ inline static int object_order(object::Type type) {
 // sort: Killer, Apple, Exit, Start
 void level::sort_objects() {
     int count = 0;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         object* obj = objects[i];
         if (obj) {
             count++;
@@ -1178,14 +1167,15 @@ void level::sort_objects() {
     }
 
     // Sort in following priority: Killer, Apple, Exit, Start
-    std::stable_sort(objects, objects + count, [](const object* a, const object* b) {
-        return object_order(a->type) < object_order(b->type);
-    });
+    std::stable_sort(objects.begin(), objects.begin() + count,
+                     [](const object* a, const object* b) {
+                         return object_order(a->type) < object_order(b->type);
+                     });
 }
 
 object* level::get_object(int index) {
-    if (index < 0 || index >= MAX_OBJECTS) {
-        internal_error("level::get_object index < 0 || index >= MAX_OBJECTS!");
+    if (index < 0 || index >= (int)objects.size()) {
+        internal_error("level::get_object index < 0 || index >= objects.size()!");
     }
 
     object* obj = objects[index];
@@ -1201,7 +1191,7 @@ void level::flip_objects() {
         return;
     }
     objects_flipped = true;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         object* obj = objects[i];
         if (obj) {
             obj->r.y = -obj->r.y;
@@ -1215,7 +1205,7 @@ void level::unflip_objects() {
     }
 
     objects_flipped = false;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
+    for (int i = 0; i < (int)objects.size(); i++) {
         object* obj = objects[i];
         if (obj) {
             obj->r.y = -obj->r.y;
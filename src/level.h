@@ -3,6 +3,7 @@
 
 #include "state.h"
 #include "vect2.h"
+#include <vector>
 
 class lgrfile;
 struct motorst;
@@ -10,10 +11,24 @@ class object;
 class polygon;
 class sprite;
 
+// Limits of the original game. With the extended_levels setting, levels may have up to the
+// _EXTENDED limits instead, see max_polygons() etc.
 constexpr int MAX_POLYGONS = 300;
 constexpr int MAX_VERTICES = 5000;
-constexpr int MAX_OBJECTS = 52;
 constexpr int MAX_SPRITES = 5000;
+constexpr int MAX_POLYGONS_EXTENDED = 100000;
+constexpr int MAX_VERTICES_EXTENDED = 1000000;
+constexpr int MAX_SPRITES_EXTENDED = 100000;
+// Most objects the editor lets a level have, as in the original game. Levels made elsewhere
+// may have up to MAX_LOADED_OBJECTS.
+constexpr int MAX_OBJECTS = 52;
+constexpr int MAX_LOADED_OBJECTS = 10000;
+
+// Current limits, depending on the extended_levels setting
+int max_polygons();
+// Total vertices of all polygons (and of the solid ones in segments)
+int max_vertices();
+int max_sprites();
 
 constexpr int LEVEL_NAME_LENGTH = 50;
 constexpr int LEVEL_NAME_LENGTH_OLD = 14;
@@ -26,9 +41,10 @@ class level {
     int level_id;
     bool lgr_not_found;
     bool topology_errors;
-    polygon* polygons[MAX_POLYGONS];
-    object* objects[MAX_OBJECTS];
-    sprite* sprites[MAX_SPRITES];
+    // Null items are deleted polygons/objects/sprites (editor only)
+    std::vector<polygon*> polygons;
+    std::vector<object*> objects;
+    std::vector<sprite*> sprites;
     char level_name[LEVEL_NAME_LENGTH + 1];
     char lgr_name[16];
     char foreground_name[10];
@@ -77,7 +93,8 @@ class level {
     void unflip_objects();
 };
 
-extern vect2 BikeStartOffset;
+// Set by initialize_objects(), per thread so worlds can be set up concurrently
+extern thread_local vect2 BikeStartOffset;
 
 // Similar to access(). Return 0 if level exists. Internal levels always exist.
 int access_level_file(const char* filename);
@@ -14,6 +14,7 @@
 #include "main.h"
 #include "menu_pic.h"
 #include "pic8.h"
+#include "physics_init.h"
 #include "piclist.h"
 #include "platform_impl.h"
 #include "platform_utils.h"
@@ -103,6 +104,20 @@ void lgrfile::load_lgr_file(char* lgr_name) {
     return;
 }
 
+lgrfile* lgrfile::load_scaled_copy() {
+    if (!Lgr) {
+        internal_error("load_scaled_copy !Lgr!");
+    }
+    return new lgrfile(CurrentLgrName);
+}
+
+void lgrfile::delete_scaled_copy(lgrfile* copy) {
+    if (copy == Lgr) {
+        internal_error("delete_scaled_copy copy == Lgr!");
+    }
+    delete copy;
+}
+
 static void bike_slice(pic8* bike, affine_pic** ret, bike_box* bbox) {
     pic8* slice = new pic8(bbox->x2 - bbox->x1 + 1, bbox->y2 - bbox->y1 + 1);
     blit8(slice, bike, -bbox->x1, -bbox->y1);
@@ -471,7 +486,7 @@ lgrfile::lgrfile(const char* lgrname) {
     memset(food, 0, sizeof(food));
     grass_pics = new grass;
 
-    double zoom = EolSettings->zoom();
+    double zoom = render_zoom();
 
     // Load file
     char path[30];
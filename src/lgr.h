@@ -77,6 +77,10 @@ class lgrfile {
 
   public:
     static void load_lgr_file(char* lgr_name);
+    // Load another copy of the current LGR, with its pictures scaled to the current render_zoom().
+    // Lgr stays the loaded LGR, the copy is owned by the caller:
+    static lgrfile* load_scaled_copy();
+    static void delete_scaled_copy(lgrfile* copy);
 
     int picture_count;
     picture pictures[MAX_PICTURES];
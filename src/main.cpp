@@ -30,6 +30,8 @@ void delay(int milliseconds) {
 
 eol_settings* EolSettings = nullptr;
 
+// Benchmark tools link this file too, with their own main():
+#ifndef ELMA_NO_MAIN
 int main() {
     EolSettings = new eol_settings();
     eol_settings::read_settings();
@@ -48,6 +50,7 @@ int main() {
 
     menu_intro();
 }
+#endif
 
 void quit() { exit(0); }
 
@@ -266,7 +266,7 @@ constexpr int UNIVERSAL_KEYS_END = UNIVERSAL_KEYS_START + 4;
 constexpr int PLAYER_KEYS_START = 0;
 constexpr int PLAYER_KEYS_END = PLAYER_KEYS_START + 10;
 constexpr int REPLAY_KEYS_START = 0;
-constexpr int REPLAY_KEYS_END = REPLAY_KEYS_START + 6;
+constexpr int REPLAY_KEYS_END = REPLAY_KEYS_START + 9;
 
 // Setup the menu to display one control key
 static void load_control(key_pointers keys, int offset, const char* label, int* key) {
@@ -354,6 +354,9 @@ static void load_replay_controls(key_pointers keys) {
     load_control(keys, i++, "Slow motion 2x", &State->key_replay_slow_2x);
     load_control(keys, i++, "Slow motion 4x", &State->key_replay_slow_4x);
     load_control(keys, i++, "Pause", &State->key_replay_pause);
+    load_control(keys, i++, "Rewind", &State->key_replay_rewind);
+    load_control(keys, i++, "Skip back 5s", &State->key_replay_skip_back);
+    load_control(keys, i++, "Skip forward 5s", &State->key_replay_skip_forward);
 }
 
 // Setup the menu to display one player's controls
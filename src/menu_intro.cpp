@@ -14,6 +14,7 @@
 #include "pic8.h"
 #include "platform_impl.h"
 #include "recorder.h"
+#include "replay_library.h"
 #include "state.h"
 #include "qopen.h"
 #include <cstring>
@@ -61,6 +62,10 @@ void menu_intro() {
     Rec1 = new recorder;
     Rec2 = new recorder;
 
+    // Read the headers of new replays while the intro is shown
+    ReplayLibrary = new replay_library;
+    ReplayLibrary->refresh_async();
+
     seteditorpal();
 
     // Initialize stopwatch, just in case
@@ -15,9 +15,9 @@
 int NavEntriesLeftMaxLength = 1;
 
 nav_entry* NavEntriesLeft = nullptr;
-nav_entry NavEntriesRight[NAV_ENTRIES_RIGHT_MAX_LENGTH + 1];
+nav_entry* NavEntriesRight = nullptr;
 
-// Initialize the left column by counting the total number of .lev and .rec files to use as the
+// Initialize the columns by counting the total number of .lev and .rec files to use as the
 // maximum column length
 void menu_nav_entries_init() {
     if (NavEntriesLeft) {
@@ -54,7 +54,8 @@ void menu_nav_entries_init() {
     }
 
     NavEntriesLeft = new nav_entry[max_count + 10];
-    if (!NavEntriesLeft) {
+    NavEntriesRight = new nav_entry[max_count + 10];
+    if (!NavEntriesLeft || !NavEntriesRight) {
         internal_error("menu_nav_entries_init out of memory!");
     }
     NavEntriesLeftMaxLength = max_count;
@@ -76,7 +77,7 @@ menu_nav::menu_nav() {
     y_title = 30;
     menu = nullptr;
     search_pattern = SearchPattern::None;
-    search_skip_one = false;
+    search_skip = 0;
 }
 
 menu_nav::~menu_nav() {
@@ -111,9 +112,6 @@ void menu_nav::setup(int len, bool two_col) {
     if (length < 1 || length > NavEntriesLeftMaxLength) {
         internal_error("menu_nav::setup length too long!");
     }
-    if (two_columns && length > NAV_ENTRIES_RIGHT_MAX_LENGTH) {
-        internal_error("menu_nav::setup length too long (two_columns)!");
-    }
     entries_left = new nav_entry[length];
     if (!entries_left) {
         internal_error("menu_nav::setup out of memory!");
@@ -343,9 +341,7 @@ bool menu_nav::search_handler(int code) {
 
     nav_entry* begin = entries_left;
     nav_entry* end = entries_left + length;
-    if (search_skip_one) {
-        ++begin;
-    }
+    begin += search_skip;
 
     switch (search_pattern) {
     case SearchPattern::Sorted: {
@@ -355,7 +351,7 @@ bool menu_nav::search_handler(int code) {
             [](const nav_entry& entry, const char* k) { return strcmpi(entry, k) < 0; });
         selected_index = match - entries_left;
 
-        if (selected_index != length && selected_index > 0 &&
+        if (selected_index != length && selected_index > search_skip &&
             strnicmp(*match, search_input.c_str(), search_input.length()) != 0) {
             size_t a = common_prefix_len(search_input.c_str(), entries_left[selected_index]);
             size_t b = common_prefix_len(search_input.c_str(), entries_left[selected_index - 1]);
@@ -15,7 +15,8 @@ constexpr int NAV_ENTRIES_RIGHT_MAX_LENGTH = 110;
 typedef char nav_entry[NAV_ENTRY_TEXT_MAX_LENGTH + 2];
 
 extern nav_entry* NavEntriesLeft;
-extern nav_entry NavEntriesRight[NAV_ENTRIES_RIGHT_MAX_LENGTH + 1];
+// As long as NavEntriesLeft, but fixed menus only use the first NAV_ENTRIES_RIGHT_MAX_LENGTH
+extern nav_entry* NavEntriesRight;
 
 void menu_nav_entries_init();
 
@@ -39,7 +40,8 @@ class menu_nav {
     bool enable_esc;
     char title[100];
     SearchPattern search_pattern;
-    bool search_skip_one;
+    // Number of entries at the top that search skips
+    int search_skip;
 
     menu_nav();
     ~menu_nav();
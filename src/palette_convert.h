@@ -0,0 +1,13 @@
+#ifndef PALETTE_CONVERT_H
+#define PALETTE_CONVERT_H
+
+// Packs an 8-bit per channel color into RGB565
+inline unsigned short rgb565(unsigned char r, unsigned char g, unsigned char b) {
+    return (unsigned short)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// Converts `width` palette indices into RGB565 pixels through a 256-entry lookup table
+void palette_row_to_rgb565(const unsigned char* src, unsigned short* dst, int width,
+                           const unsigned short* lut);
+
+#endif
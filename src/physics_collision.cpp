@@ -7,32 +7,39 @@
 #include "physics_init.h"
 #include "segments.h"
 #include "vect2.h"
+#include "world.h"
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-// Check for collision between a wheel/head of a certain radius, and a provided segment.
+// Check for collision between a wheel/head of a certain radius, and a segment starting at seg_r.
 // If there is a collision, return true and get the point of collision along the segment.
-static bool get_anchor_point(vect2 r, double radius, segment* seg, vect2* point) {
+static bool get_anchor_point(vect2 r, double radius, vect2 seg_r, vect2 seg_unit_vector,
+                             double seg_length, vect2* point) {
     // Get relative position
-    vect2 rel = r - seg->r;
+    vect2 rel = r - seg_r;
     // The closest point of collision between a point and line is always perpendicular to the line
     // Figure out where along the line is the closest point of collision
-    // 0 is the start of the segment, and seg->length is the end of the segment
-    double position_along_line = rel * seg->unit_vector;
+    // 0 is the start of the segment, and seg_length is the end of the segment
+    double position_along_line = rel * seg_unit_vector;
     if (position_along_line < 0) {
         // We are behind the segment
-        if ((r - seg->r).length() < radius) {
+        if ((r - seg_r).length() < radius) {
             // Return the very start of the segment
-            *point = seg->r;
+            *point = seg_r;
             return true;
         } else {
             // Too far, no collision
             return false;
         }
     }
-    if (position_along_line > seg->length) {
+    if (position_along_line > seg_length) {
         // We are in front of the segment
-        if ((r - (seg->r + seg->unit_vector * seg->length)).length() < radius) {
+        if ((r - (seg_r + seg_unit_vector * seg_length)).length() < radius) {
             // Return the very end of the segment
-            *point = seg->r + seg->unit_vector * seg->length;
+            *point = seg_r + seg_unit_vector * seg_length;
             return true;
         } else {
             // Too far, no collision
@@ -41,77 +48,160 @@ static bool get_anchor_point(vect2 r, double radius, segment* seg, vect2* point)
     }
     // We are neither behind nor in front of the segment, so we will collide somewhere in the middle
     // First, make sure we aren't too far away from the line to touch
-    vect2 n = rotate_90deg(seg->unit_vector);
+    vect2 n = rotate_90deg(seg_unit_vector);
     double distance = rel * n;
     if (distance < -radius || distance > radius) {
         return false;
     }
     // Calculate where along the segment we will touch
-    *point = seg->r + seg->unit_vector * position_along_line;
+    *point = seg_r + seg_unit_vector * position_along_line;
     return true;
 }
 
-int get_two_anchor_points(vect2 r, double radius, vect2* point1, vect2* point2) {
+// Added to the radius in near_segment_pair(), far above any rounding difference between the
+// squared distances there and the distances in get_anchor_point()
+constexpr double NEAR_SEGMENT_SLACK = 0.00000001;
+
+// Squared-distance prefilter for two segments of a collision cell, items i and i + 1.
+// Returns a bit mask (bit 0: item i, bit 1: item i + 1) of the segments whose closest point lies
+// within sqrt(reach2) of r. Only those can pass get_anchor_point(), which stays the exact test.
+static inline int near_segment_pair(const collision_cell& cell, int i, vect2 r, double reach2) {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    float64x2_t relx = vsubq_f64(vdupq_n_f64(r.x), vld1q_f64(cell.rx + i));
+    float64x2_t rely = vsubq_f64(vdupq_n_f64(r.y), vld1q_f64(cell.ry + i));
+    float64x2_t ux = vld1q_f64(cell.unit_x + i);
+    float64x2_t uy = vld1q_f64(cell.unit_y + i);
+    // Projection onto the segment, clamped to its endpoints
+    float64x2_t t = vaddq_f64(vmulq_f64(relx, ux), vmulq_f64(rely, uy));
+    t = vminq_f64(vmaxq_f64(t, vdupq_n_f64(0.0)), vld1q_f64(cell.length + i));
+    float64x2_t dx = vsubq_f64(relx, vmulq_f64(ux, t));
+    float64x2_t dy = vsubq_f64(rely, vmulq_f64(uy, t));
+    float64x2_t distance2 = vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy));
+    uint64x2_t near = vcleq_f64(distance2, vdupq_n_f64(reach2));
+    return (int)(vgetq_lane_u64(near, 0) & 1) | (int)(vgetq_lane_u64(near, 1) & 2);
+#elif defined(__SSE2__)
+    __m128d relx = _mm_sub_pd(_mm_set1_pd(r.x), _mm_loadu_pd(cell.rx + i));
+    __m128d rely = _mm_sub_pd(_mm_set1_pd(r.y), _mm_loadu_pd(cell.ry + i));
+    __m128d ux = _mm_loadu_pd(cell.unit_x + i);
+    __m128d uy = _mm_loadu_pd(cell.unit_y + i);
+    // Projection onto the segment, clamped to its endpoints
+    __m128d t = _mm_add_pd(_mm_mul_pd(relx, ux), _mm_mul_pd(rely, uy));
+    t = _mm_min_pd(_mm_max_pd(t, _mm_setzero_pd()), _mm_loadu_pd(cell.length + i));
+    __m128d dx = _mm_sub_pd(relx, _mm_mul_pd(ux, t));
+    __m128d dy = _mm_sub_pd(rely, _mm_mul_pd(uy, t));
+    __m128d distance2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+    return _mm_movemask_pd(_mm_cmple_pd(distance2, _mm_set1_pd(reach2)));
+#else
+    int near = 0;
+    for (int lane = 0; lane < 2; lane++) {
+        double relx = r.x - cell.rx[i + lane];
+        double rely = r.y - cell.ry[i + lane];
+        double t = relx * cell.unit_x[i + lane] + rely * cell.unit_y[i + lane];
+        t = t < 0.0 ? 0.0 : (t > cell.length[i + lane] ? cell.length[i + lane] : t);
+        double dx = relx - cell.unit_x[i + lane] * t;
+        double dy = rely - cell.unit_y[i + lane] * t;
+        if (dx * dx + dy * dy <= reach2) {
+            near |= 1 << lane;
+        }
+    }
+    return near;
+#endif
+}
+
+int get_two_anchor_points(world* wld, vect2 r, double radius, vect2* point1, vect2* point2) {
     // Iterate through all the lines in one collision cell
-    Segments->iterate_collision_grid_cell_segments(r);
+    collision_cell cell = wld->segs->get_collision_grid_cell(r);
+    // Nothing in reach, as most of the time in the air
+    if (cell.clearance > radius) {
+        return 0;
+    }
     int anchor_point_count = 0;
-    segment* seg = nullptr;
-    while ((seg = Segments->next_collision_grid_segment())) {
-        // Find the point of collision between the wheel/head and the line
-        vect2 point;
-        if (get_anchor_point(r, radius, seg, &point)) {
-            if (anchor_point_count == 2) {
-                internal_error("anchor_point_count == 2");
+    double reach = radius + NEAR_SEGMENT_SLACK;
+    double reach2 = reach * reach;
+    // Most segments of the cell are out of reach, skip them two at a time
+    for (int pair = 0; pair < cell.count; pair += 2) {
+        int near = near_segment_pair(cell, pair, r, reach2);
+        if (pair + 1 == cell.count) {
+            near &= 1;
+        }
+        for (int i = pair; near; i++, near >>= 1) {
+            if (!(near & 1)) {
+                continue;
             }
-            // Verify our second collision
-            if (anchor_point_count == 1) {
-                *point2 = point;
-                anchor_point_count++;
-                // If the first and second collision are too close together,
-                // average out the two points and treat it as a single point, then keep searching.
-                // This should trigger when you touch a vertex, as two segments touch at a vertex.
-                // This is also affects vsync bugs when many vertices are super close together.
-                if ((*point1 - *point2).length() < TwoPointDiscriminationDistance) {
-                    *point1 = (*point1 + *point2) * 0.5;
-                    anchor_point_count = 1;
-                } else {
-                    // We found a valid second point, we're done!
-                    return anchor_point_count;
+            // Find the point of collision between the wheel/head and the line
+            vect2 point;
+            if (get_anchor_point(r, radius, vect2(cell.rx[i], cell.ry[i]),
+                                 vect2(cell.unit_x[i], cell.unit_y[i]), cell.length[i], &point)) {
+                if (anchor_point_count == 2) {
+                    internal_error("anchor_point_count == 2");
+                }
+                // Verify our second collision
+                if (anchor_point_count == 1) {
+                    *point2 = point;
+                    anchor_point_count++;
+                    // If the first and second collision are too close together,
+                    // average out the two points and treat it as a single point, then keep
+                    // searching. This should trigger when you touch a vertex, as two segments
+                    // touch at a vertex. This is also affects vsync bugs when many vertices are
+                    // super close together.
+                    if ((*point1 - *point2).length() < TwoPointDiscriminationDistance) {
+                        *point1 = (*point1 + *point2) * 0.5;
+                        anchor_point_count = 1;
+                    } else {
+                        // We found a valid second point, we're done!
+                        return anchor_point_count;
+                    }
+                }
+                // Always accept our first collision
+                if (anchor_point_count == 0) {
+                    *point1 = point;
+                    anchor_point_count++;
                 }
-            }
-            // Always accept our first collision
-            if (anchor_point_count == 0) {
-                *point1 = point;
-                anchor_point_count++;
             }
         }
     }
     return anchor_point_count;
 }
 
-int get_touching_object(vect2 r, double radius) {
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        object* obj = Ptop->objects[i];
-        if (!obj) {
-            break;
-        }
+int get_touching_object(world* wld, vect2 r, double radius) {
+    // Only the objects with their center in reach can touch, return the first of them in object
+    // order
+    double max_distance = radius + ObjectRadius;
+    vect2 reach(max_distance, max_distance);
+    int cell_x1, cell_y1, cell_x2, cell_y2;
+    wld->segs->get_object_grid_range(r - reach, r + reach, &cell_x1, &cell_y1, &cell_x2,
+                                     &cell_y2);
+    int first = -1;
+    for (int cell_y = cell_y1; cell_y <= cell_y2; cell_y++) {
+        for (int cell_x = cell_x1; cell_x <= cell_x2; cell_x++) {
+            const int* indices;
+            int count = wld->segs->get_object_grid_cell(cell_x, cell_y, &indices);
+            for (int j = 0; j < count; j++) {
+                int i = indices[j];
+                // The items of a cell are in object order, no later one can come first
+                if (first >= 0 && i > first) {
+                    break;
+                }
+                object* obj = wld->lev->objects[i];
 
-        // Skip Start object and eaten Food
-        if (!obj->active) {
-            continue;
-        }
+                // Skip Start object and eaten Food
+                if (!obj->active) {
+                    continue;
+                }
 
-        // Skip Exit in flagtag mode
-        if (obj->type == object::Type::Exit && !Single && Tag) {
-            continue;
-        }
+                // Skip Exit in flagtag mode
+                if (obj->type == object::Type::Exit && !wld->single && wld->tag) {
+                    continue;
+                }
 
-        vect2 diff = r - obj->r;
-        double max_distance = radius + ObjectRadius;
-        if (diff.x * diff.x + diff.y * diff.y < max_distance * max_distance) {
-            return i;
+                vect2 diff = r - obj->r;
+                if (diff.x * diff.x + diff.y * diff.y < max_distance * max_distance) {
+                    first = i;
+                    break;
+                }
+            }
         }
     }
 
-    return -1;
+    return first;
 }
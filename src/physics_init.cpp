@@ -1,5 +1,6 @@
 #include "eol_settings.h"
 #include "physics_init.h"
+#include <algorithm>
 
 static motorst Motorst1;
 static motorst Motorst2;
@@ -76,12 +77,19 @@ void init_motor(motorst* motor) {
     motor->body_v = vect2(0.0, 0.0);
 }
 
+double DynamicRenderScale = 1.0;
+
+double render_zoom() {
+    return EolSettings->zoom() / EolSettings->render_divisor() * DynamicRenderScale;
+}
+
 void set_zoom_factor() {
-    double zoom_factor = 0.48 * EolSettings->zoom();
+    double zoom_factor = 0.48 * render_zoom();
     MetersToPixels = 100.0 * zoom_factor;
     PixelsToMeters = 1.0 / MetersToPixels;
 
-    MinimapScaleFactor = (int)(0.42 * MetersToPixels * 0.5);
+    // Divided by in the minimap code, low zoom with a high render_divisor would round it to 0
+    MinimapScaleFactor = std::max(1, (int)(0.42 * MetersToPixels * 0.5));
 }
 
 void init_physics_data(void) {
@@ -73,6 +73,12 @@ struct motorst {
 
 extern motorst *Motor1, *Motor2;
 
+// Internal picture scale of the dynamic-resolution step in use (valtrenderskalat() in ECSET.CPP),
+// 1.0 without it and outside of play
+extern double DynamicRenderScale;
+// Zoom the game view is rasterized at: EolSettings->zoom() divided by render_divisor(), times
+// DynamicRenderScale
+double render_zoom();
 void set_zoom_factor();
 void init_physics_data();
 void init_motor(motorst* motor);
@@ -3,6 +3,7 @@
 #include "physics_init.h"
 #include "recorder.h"
 #include "sound_engine.h"
+#include "world.h"
 #include <cmath>
 
 // Push the wheel out from the ground so it is standing on the anchor point
@@ -20,7 +21,8 @@ constexpr double BumpThreshold = 1.5;
 // Handle collision between a wheel and one anchor point
 // Return true if there is collision
 // Delete all of the velocity towards the point and keep velocity perpendicular to the point
-static bool simulate_anchor_point_collision(rigidbody* rb, vect2* point, vect2 force) {
+static bool simulate_anchor_point_collision(world* wld, rigidbody* rb, vect2* point,
+                                            vect2 force) {
     // Return false if no collision
     double length = (rb->r - *point).length();
     vect2 n = (rb->r - *point) * (1.0 / length);
@@ -37,7 +39,7 @@ static bool simulate_anchor_point_collision(rigidbody* rb, vect2* point, vect2 f
         if (bump_magnitude >= 0.99) {
             bump_magnitude = 0.99;
         }
-        add_event_buffer(WavEvent::Bump, bump_magnitude, -1);
+        wld->events.add(WavEvent::Bump, bump_magnitude, -1);
     }
     return true;
 }
@@ -81,14 +83,15 @@ static bool valid_anchor_points_new(vect2 point1, vect2 point2, rigidbody* rb) {
 
 // Handle wheel/bike movement
 // do_collision = true if solid object (i.e. wheels and not bike)
-void rigidbody_movement(rigidbody* rb, vect2 force, double torque, double dt, bool do_collision) {
+void rigidbody_movement(world* wld, rigidbody* rb, vect2 force, double torque, double dt,
+                        bool do_collision) {
     int anchor_point_count = 0;
     vect2 point1;
     vect2 point2;
 
     // Get up to two points of collision between wheel and polygons
     if (do_collision) {
-        anchor_point_count = get_two_anchor_points(rb->r, rb->radius, &point1, &point2);
+        anchor_point_count = get_two_anchor_points(wld, rb->r, rb->radius, &point1, &point2);
     }
 
     // Move the wheel out of the ground
@@ -130,12 +133,12 @@ void rigidbody_movement(rigidbody* rb, vect2 force, double torque, double dt, bo
     // Assuming we have only one point of collision, check to see if we actually collide with that
     // point! Discard the point if there's no collision
     if (anchor_point_count == 2) {
-        if (!simulate_anchor_point_collision(rb, &point2, force)) {
+        if (!simulate_anchor_point_collision(wld, rb, &point2, force)) {
             anchor_point_count = 1;
         }
     }
     if (anchor_point_count >= 1) {
-        if (!simulate_anchor_point_collision(rb, &point1, force)) {
+        if (!simulate_anchor_point_collision(wld, rb, &point1, force)) {
             if (anchor_point_count == 2) {
                 anchor_point_count = 1;
                 point1 = point2;
@@ -4,8 +4,10 @@
 struct motorst;
 struct rigidbody;
 class vect2;
+class world;
 
-void rigidbody_movement(rigidbody* rb, vect2 force, double torque, double dt, bool do_collision);
+void rigidbody_movement(world* wld, rigidbody* rb, vect2 force, double torque, double dt,
+                        bool do_collision);
 void body_movement(motorst* mot, vect2 gravity, vect2 i, vect2 j, double dt);
 
 #endif
@@ -6,6 +6,7 @@
 #include "qopen.h"
 #include <algorithm>
 #include <cstring>
+#include <vector>
 
 void pic8::allocate(int w, int h) {
     if (rows || pixels) {
@@ -800,12 +801,25 @@ void blit_scale8(pic8* dest, pic8* source, int x1, int y1, int x2, int y2) {
     int yss = source->get_height();
     double s_per_d_y = (double)yss / ysd;
     double s_per_d_x = (double)xss / xsd;
+    // Also used every frame to upscale the game view, so the source column of each destination
+    // column is only computed once, and repeated source rows are copied
+    std::vector<int> source_x(xsd);
+    for (int x = 0; x < xsd; x++) {
+        double sx = (x + 0.5) * s_per_d_x;
+        source_x[x] = (int)(sx);
+    }
+    int previous_sy = -1;
     for (int y = 0; y < ysd; y++) {
         double sy = (y + 0.5) * s_per_d_y;
+        unsigned char* dest_row = dest->get_row(y1 + y) + x1;
+        if ((int)(sy) == previous_sy) {
+            memcpy(dest_row, dest->get_row(y1 + y - 1) + x1, xsd);
+            continue;
+        }
+        previous_sy = (int)(sy);
+        const unsigned char* source_row = source->get_row(previous_sy);
         for (int x = 0; x < xsd; x++) {
-            double sx = (x + 0.5) * s_per_d_x;
-            unsigned char c = source->gpixel((int)(sx), (int)(sy));
-            dest->ppixel(x1 + x, y1 + y, c);
+            dest_row[x] = source_row[source_x[x]];
         }
     }
 }
@@ -0,0 +1,255 @@
+#include "platform_headless.h"
+#include "main.h"
+#include "M_PIC.H"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// In-memory implementation of platform_impl.h for benchmarks and CI.
+// Frames are rendered into a plain paletted buffer, time is virtual and input comes from a script.
+
+enum class ScriptEventType { KeyDown, KeyUp, KeyPress };
+
+struct script_event {
+    long long time;
+    ScriptEventType type;
+    int code;
+};
+
+static unsigned char* FramePixels = nullptr;
+static unsigned char** SurfaceBuffer = nullptr;
+static bool SurfaceLocked = false;
+
+static unsigned char PaletteRGB[768];
+
+static double VirtualMilliseconds = 0.0;
+static double FrameStep = 1000.0 / 60.0;
+static bool FramePresentedSincePoll = false;
+static long long FrameCount = 0;
+static long long MaxFrames = 0;
+static headless_present_hook PresentHook = nullptr;
+
+static bool KeyState[MaxKeycode];
+static std::vector<script_event> Script;
+static size_t NextScriptEvent = 0;
+
+void message_box(const char* text) { fprintf(stderr, "Message: %s\n", text); }
+
+void headless_set_frame_step(double milliseconds) { FrameStep = milliseconds; }
+
+void headless_advance_clock(double milliseconds) { VirtualMilliseconds += milliseconds; }
+
+static void add_script_event(long long time, ScriptEventType type, int code) {
+    // Keep the script sorted by time, events at the same time stay in the order they were added
+    script_event event = {time, type, code};
+    auto it = std::upper_bound(
+        Script.begin() + NextScriptEvent, Script.end(), event,
+        [](const script_event& a, const script_event& b) { return a.time < b.time; });
+    Script.insert(it, event);
+}
+
+void headless_script_key(long long at_milliseconds, DikScancode code, bool down) {
+    if (code < 0 || code >= MaxKeycode) {
+        internal_error("code out of range in headless_script_key()!");
+        return;
+    }
+    add_script_event(at_milliseconds, down ? ScriptEventType::KeyDown : ScriptEventType::KeyUp,
+                     code);
+}
+
+void headless_script_keypress(long long at_milliseconds, Keycode keycode) {
+    add_script_event(at_milliseconds, ScriptEventType::KeyPress, keycode);
+}
+
+bool headless_load_script(const char* filename) {
+    FILE* h = fopen(filename, "r");
+    if (!h) {
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), h)) {
+        long long time;
+        char type[16];
+        int code;
+        if (sscanf(line, "%lld %15s %d", &time, type, &code) != 3) {
+            continue; // Comments and empty lines
+        }
+        if (strcmp(type, "down") == 0) {
+            headless_script_key(time, code, true);
+        } else if (strcmp(type, "up") == 0) {
+            headless_script_key(time, code, false);
+        } else if (strcmp(type, "press") == 0) {
+            headless_script_keypress(time, code);
+        }
+    }
+    fclose(h);
+    return true;
+}
+
+void headless_set_present_hook(headless_present_hook hook) { PresentHook = hook; }
+
+long long headless_frame_count() { return FrameCount; }
+
+const unsigned char* headless_frame_pixels() { return FramePixels; }
+
+const unsigned char* headless_palette_rgb() { return PaletteRGB; }
+
+static void create_frame_buffer() {
+    delete[] FramePixels;
+    FramePixels = new unsigned char[SCREEN_WIDTH * SCREEN_HEIGHT];
+    memset(FramePixels, 0, SCREEN_WIDTH * SCREEN_HEIGHT);
+}
+
+void platform_init() {
+    SurfaceBuffer = new unsigned char*[SCREEN_HEIGHT];
+    create_frame_buffer();
+
+    // Lets the regular game binary run unattended:
+    const char* script = getenv("ELMA_HEADLESS_SCRIPT");
+    if (script && !headless_load_script(script)) {
+        internal_error("Failed to open headless script file:", script);
+    }
+    const char* max_frames = getenv("ELMA_HEADLESS_FRAMES");
+    if (max_frames) {
+        MaxFrames = atoll(max_frames);
+    }
+}
+
+void platform_recreate_window() {
+    delete[] SurfaceBuffer;
+    SurfaceBuffer = new unsigned char*[SCREEN_HEIGHT];
+    create_frame_buffer();
+}
+
+long long get_milliseconds() { return (long long)VirtualMilliseconds; }
+
+bool has_window() { return FramePixels != nullptr; }
+
+unsigned char** lock_backbuffer(bool flipped) {
+    if (SurfaceLocked) {
+        internal_error("lock_backbuffer SurfaceLocked!");
+    }
+    SurfaceLocked = true;
+
+    unsigned char* row = FramePixels;
+    if (flipped) {
+        // Set the row buffer bottom-down
+        for (int y = 0; y < SCREEN_HEIGHT; y++) {
+            SurfaceBuffer[SCREEN_HEIGHT - 1 - y] = row;
+            row += SCREEN_WIDTH;
+        }
+    } else {
+        // Set the row buffer top-down
+        for (int y = 0; y < SCREEN_HEIGHT; y++) {
+            SurfaceBuffer[y] = row;
+            row += SCREEN_WIDTH;
+        }
+    }
+
+    return SurfaceBuffer;
+}
+
+void unlock_backbuffer() {
+    if (!SurfaceLocked) {
+        internal_error("unlock_backbuffer !SurfaceLocked!");
+    }
+    SurfaceLocked = false;
+
+    if (PresentHook) {
+        PresentHook(FramePixels, SCREEN_WIDTH, SCREEN_HEIGHT, PaletteRGB);
+    }
+
+    FrameCount++;
+    VirtualMilliseconds += FrameStep;
+    FramePresentedSincePoll = true;
+
+    if (MaxFrames > 0 && FrameCount >= MaxFrames) {
+        quit();
+    }
+}
+
+unsigned char** lock_frontbuffer(bool flipped) {
+    if (SurfaceLocked) {
+        internal_error("lock_frontbuffer SurfaceLocked!");
+    }
+
+    return lock_backbuffer(flipped);
+}
+
+void unlock_frontbuffer() {
+    if (!SurfaceLocked) {
+        internal_error("unlock_frontbuffer !SurfaceLocked!");
+    }
+
+    unlock_backbuffer();
+}
+
+palette::palette(unsigned char* palette_data) {
+    unsigned char* pal = new unsigned char[768];
+    memcpy(pal, palette_data, 768);
+    data = (void*)pal;
+}
+
+palette::~palette() { delete[] (unsigned char*)data; }
+
+void palette::set() { memcpy(PaletteRGB, data, 768); }
+
+void handle_events() {
+    // Busy-wait loops (delay(), menus waiting for a key) only poll events, so time has to move
+    // forward here too or they would never finish
+    if (!FramePresentedSincePoll) {
+        VirtualMilliseconds += 1.0;
+    }
+    FramePresentedSincePoll = false;
+
+    long long now = get_milliseconds();
+    while (NextScriptEvent < Script.size() && Script[NextScriptEvent].time <= now) {
+        const script_event& event = Script[NextScriptEvent++];
+        switch (event.type) {
+        case ScriptEventType::KeyDown:
+            KeyState[event.code] = true;
+            break;
+        case ScriptEventType::KeyUp:
+            KeyState[event.code] = false;
+            break;
+        case ScriptEventType::KeyPress:
+            add_key_to_buffer(event.code);
+            break;
+        }
+    }
+}
+
+void hide_cursor() {}
+void show_cursor() {}
+
+void get_mouse_position(int* x, int* y) {
+    *x = 0;
+    *y = 0;
+}
+void set_mouse_position(int x, int y) {}
+
+bool left_mouse_clicked() {
+    handle_events();
+    return false;
+}
+
+bool right_mouse_clicked() {
+    handle_events();
+    return false;
+}
+
+bool is_key_down(DikScancode code) {
+    if (code < 0 || code >= MaxKeycode) {
+        internal_error("code out of range in is_key_down()!");
+        return false;
+    }
+
+    return KeyState[code];
+}
+
+bool is_fullscreen() { return false; }
+
+// No audio device; the mixer is simply never pulled
+void init_sound() {}
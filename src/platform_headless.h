@@ -0,0 +1,33 @@
+#ifndef PLATFORM_HEADLESS_H
+#define PLATFORM_HEADLESS_H
+
+#include "keys.h"
+#include "platform_impl.h"
+
+// Controls for the in-memory platform backend (make TARGET=headless).
+// There is no window, sound device or wall clock: get_milliseconds() only moves when a frame is
+// presented, when events are polled without a frame in between, or when advanced explicitly.
+
+// Virtual time added by every unlock_backbuffer(); defaults to one 60 Hz frame
+void headless_set_frame_step(double milliseconds);
+void headless_advance_clock(double milliseconds);
+
+// Scripted input, applied by handle_events() once the virtual clock reaches `at_milliseconds`
+void headless_script_key(long long at_milliseconds, DikScancode code, bool down);
+void headless_script_keypress(long long at_milliseconds, Keycode keycode);
+// Reads a script file with one event per line: "<ms> down <dik>", "<ms> up <dik>",
+// "<ms> press <keycode>". Returns false if the file can't be opened.
+bool headless_load_script(const char* filename);
+
+// Called after every presented frame with top-down rows and the current RGB palette
+typedef void (*headless_present_hook)(const unsigned char* pixels, int width, int height,
+                                      const unsigned char* palette_rgb);
+void headless_set_present_hook(headless_present_hook hook);
+
+long long headless_frame_count();
+// Top-down rows of the last frame, SCREEN_WIDTH bytes each
+const unsigned char* headless_frame_pixels();
+// 768 bytes, the palette last passed to palette::set()
+const unsigned char* headless_palette_rgb();
+
+#endif
@@ -9,9 +9,15 @@
 #endif
 #include "main.h"
 #include "M_PIC.H"
+#include "palette_convert.h"
 #include <SDL.h>
 #include <sdl/scancodes_windows.h>
 #include <cstring>
+#ifdef MIYOO_MINI
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 static SDL_Window* SDLWindow = nullptr;
 static SDL_Surface* SDLSurfaceMain = nullptr;
@@ -29,8 +35,19 @@ static Keycode SDLToKeycode[SDL_NUM_SCANCODES];
 #ifdef MIYOO_MINI
 static SDL_Renderer* SDLRenderer = nullptr;
 static SDL_Texture* SDLTexture = nullptr;
-static SDL_Surface* SDLSurfaceRGB = nullptr;
-static SDL_Color MiyooPalette[256];
+// RGB565 lookup table, rebuilt in palette::set()
+static Uint16 MiyooPalette[256];
+// Per-row hash of the last presented frame, only rows that differ are converted and uploaded
+static Uint64* PresentedRowHashes = nullptr;
+static bool PresentAllRows = true;
+
+// Threaded present (optional): the game draws into SDLSurfacePaletted while the present thread
+// converts and presents SDLSurfacePresenting, which holds the previous frame.
+static SDL_Surface* SDLSurfacePresenting = nullptr;
+static std::thread* PresentThread = nullptr;
+static std::mutex PresentMutex;
+static std::condition_variable PresentCondition;
+static bool PresentPending = false;
 #endif
 
 void message_box(const char* text) {
@@ -87,18 +104,14 @@ static void initialize_renderer() {
         return;
     }
 
-    // Create an RGB565 surface for manual palette→RGB conversion
-    // (SDL_BlitSurface INDEX8→RGB565 may not work in this stripped SDL2 build)
-    SDLSurfaceRGB = SDL_CreateRGBSurface(0, SCREEN_WIDTH, SCREEN_HEIGHT, 16,
-                                          0xF800, 0x07E0, 0x001F, 0x0000);
-    if (!SDLSurfaceRGB) {
-        internal_error(SDL_GetError());
-        return;
-    }
-
     // Initialize palette to all black
     memset(MiyooPalette, 0, sizeof(MiyooPalette));
 
+    if (!PresentedRowHashes) {
+        PresentedRowHashes = new Uint64[SCREEN_HEIGHT];
+    }
+    PresentAllRows = true;
+
     SDLSurfaceMain = nullptr; // Not used on Miyoo
 #else
     if (EolSettings->renderer() == RendererType::OpenGL) {
@@ -125,6 +138,17 @@ static void create_palette_surface() {
         internal_error(SDL_GetError());
         return;
     }
+
+#ifdef MIYOO_MINI
+    if (PresentThread) {
+        SDLSurfacePresenting = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 0,
+                                                              SDL_PIXELFORMAT_INDEX8);
+        if (!SDLSurfacePresenting) {
+            internal_error(SDL_GetError());
+            return;
+        }
+    }
+#endif
 }
 
 static void initialize_keyboard_mappings() {
@@ -175,6 +199,107 @@ static void initialize_keyboard_mappings() {
 #endif
 }
 
+#ifdef MIYOO_MINI
+// 64-bit multiplicative hash of a paletted row, 8 pixels at a time
+static Uint64 row_hash(const unsigned char* row, int width) {
+    Uint64 hash = 0x9E3779B97F4A7C15ull;
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        Uint64 word;
+        memcpy(&word, row + x, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ull;
+        hash ^= hash >> 29;
+    }
+    for (; x < width; x++) {
+        hash = (hash ^ row[x]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+static void present_frame(SDL_Surface* paletted) {
+    // Miyoo: manually convert the paletted surface to RGB565 straight into the locked
+    // streaming texture, then present.
+    // We do manual conversion because SDL_BlitSurface INDEX8→RGB565 may not work
+    // in the stripped mmiyoo SDL2 build.
+    // Only bands of rows that changed since the last present are converted and uploaded.
+    const unsigned char* src = (const unsigned char*)paletted->pixels;
+    int src_pitch = paletted->pitch;
+    // The hashes of a band are stored before it is uploaded, so if that fails the next present
+    // has to upload every row again:
+    bool upload_failed = false;
+    int y = 0;
+    while (y < SCREEN_HEIGHT) {
+        // Find next changed row:
+        Uint64 hash = row_hash(src + y * src_pitch, SCREEN_WIDTH);
+        if (!PresentAllRows && hash == PresentedRowHashes[y]) {
+            y++;
+            continue;
+        }
+        PresentedRowHashes[y] = hash;
+
+        // Extend band while rows keep changing:
+        int band_end = y + 1;
+        while (band_end < SCREEN_HEIGHT) {
+            hash = row_hash(src + band_end * src_pitch, SCREEN_WIDTH);
+            if (!PresentAllRows && hash == PresentedRowHashes[band_end]) {
+                break;
+            }
+            PresentedRowHashes[band_end] = hash;
+            band_end++;
+        }
+
+        SDL_Rect band = {0, y, SCREEN_WIDTH, band_end - y};
+        void* texture_pixels;
+        int texture_pitch;
+        if (SDL_LockTexture(SDLTexture, &band, &texture_pixels, &texture_pitch) == 0) {
+            unsigned char* dst = (unsigned char*)texture_pixels;
+            for (int row = y; row < band_end; row++) {
+                palette_row_to_rgb565(src + row * src_pitch, (Uint16*)dst, SCREEN_WIDTH,
+                                      MiyooPalette);
+                dst += texture_pitch;
+            }
+            SDL_UnlockTexture(SDLTexture);
+        } else {
+            upload_failed = true;
+        }
+        // The row after the band is known to be unchanged:
+        y = band_end + 1;
+    }
+    PresentAllRows = upload_failed;
+
+    SDL_RenderClear(SDLRenderer);
+    SDL_RenderCopy(SDLRenderer, SDLTexture, NULL, NULL);
+    SDL_RenderPresent(SDLRenderer);
+}
+
+static void present_thread_main() {
+    std::unique_lock<std::mutex> lock(PresentMutex);
+    while (true) {
+        PresentCondition.wait(lock, [] { return PresentPending; });
+        lock.unlock();
+        present_frame(SDLSurfacePresenting);
+        lock.lock();
+        PresentPending = false;
+        PresentCondition.notify_all();
+    }
+}
+
+static void start_present_thread() {
+    // Detached, as quit() exits without tearing anything down
+    PresentThread = new std::thread(present_thread_main);
+    PresentThread->detach();
+}
+
+// Blocks until the present thread is done with SDLSurfacePresenting
+static void wait_for_present() {
+    if (!PresentThread) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(PresentMutex);
+    PresentCondition.wait(lock, [] { return !PresentPending; });
+}
+#endif
+
 void platform_init() {
 #ifdef MIYOO_MINI
     // Enable double buffering for the mmiyoo framebuffer driver (must be set before SDL_Init)
@@ -192,6 +317,11 @@ void platform_init() {
 
     create_window(SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT);
     initialize_renderer();
+#ifdef MIYOO_MINI
+    if (EolSettings->threaded_present()) {
+        start_present_thread();
+    }
+#endif
     create_palette_surface();
     initialize_keyboard_mappings();
 
@@ -214,15 +344,19 @@ void platform_recreate_window() {
     gl_cleanup();
 #endif
 
+#ifdef MIYOO_MINI
+    wait_for_present();
+#endif
+
     if (SDLSurfacePaletted) {
         SDL_FreeSurface(SDLSurfacePaletted);
         SDLSurfacePaletted = nullptr;
     }
 
 #ifdef MIYOO_MINI
-    if (SDLSurfaceRGB) {
-        SDL_FreeSurface(SDLSurfaceRGB);
-        SDLSurfaceRGB = nullptr;
+    if (SDLSurfacePresenting) {
+        SDL_FreeSurface(SDLSurfacePresenting);
+        SDLSurfacePresenting = nullptr;
     }
     if (SDLTexture) {
         SDL_DestroyTexture(SDLTexture);
@@ -284,29 +418,24 @@ void unlock_backbuffer() {
     SurfaceLocked = false;
 
 #ifdef MIYOO_MINI
-    // Miyoo: manually convert paletted surface to RGB565, then upload to texture and present.
-    // We do manual conversion because SDL_BlitSurface INDEX8→RGB565 may not work
-    // in the stripped mmiyoo SDL2 build.
-    {
-        const unsigned char* src = (const unsigned char*)SDLSurfacePaletted->pixels;
-        Uint16* dst = (Uint16*)SDLSurfaceRGB->pixels;
-        int src_pitch = SDLSurfacePaletted->pitch;
-        int dst_pitch = SDLSurfaceRGB->pitch / 2; // pitch in Uint16 units
-        for (int y = 0; y < SCREEN_HEIGHT; y++) {
-            const unsigned char* src_row = src + y * src_pitch;
-            Uint16* dst_row = dst + y * dst_pitch;
-            for (int x = 0; x < SCREEN_WIDTH; x++) {
-                const SDL_Color& c = MiyooPalette[src_row[x]];
-                dst_row[x] = ((Uint16)(c.r >> 3) << 11) |
-                             ((Uint16)(c.g >> 2) << 5) |
-                             ((Uint16)(c.b >> 3));
-            }
+    if (PresentThread) {
+        wait_for_present();
+        SDL_Surface* finished = SDLSurfacePaletted;
+        SDLSurfacePaletted = SDLSurfacePresenting;
+        SDLSurfacePresenting = finished;
+        {
+            std::lock_guard<std::mutex> lock(PresentMutex);
+            PresentPending = true;
         }
+        PresentCondition.notify_all();
+
+        // Menus and the editor only redraw what changed, so the next frame has to start
+        // from the one just handed over:
+        memcpy(SDLSurfacePaletted->pixels, SDLSurfacePresenting->pixels,
+               SDLSurfacePresenting->pitch * SCREEN_HEIGHT);
+    } else {
+        present_frame(SDLSurfacePaletted);
     }
-    SDL_UpdateTexture(SDLTexture, NULL, SDLSurfaceRGB->pixels, SDLSurfaceRGB->pitch);
-    SDL_RenderClear(SDLRenderer);
-    SDL_RenderCopy(SDLRenderer, SDLTexture, NULL, NULL);
-    SDL_RenderPresent(SDLRenderer);
 #else
     if (EolSettings->renderer() == RendererType::OpenGL) {
         gl_upload_frame((unsigned char*)SDLSurfacePaletted->pixels);
@@ -350,10 +479,19 @@ palette::~palette() { delete[] (SDL_Color*)data; }
 
 void palette::set() {
 #ifdef MIYOO_MINI
-    // Store palette for manual RGB565 conversion in unlock_backbuffer
-    memcpy(MiyooPalette, (const SDL_Color*)data, 256 * sizeof(SDL_Color));
+    // Rebuild the RGB565 lookup table used by unlock_backbuffer
+    wait_for_present();
+    const SDL_Color* colors = (const SDL_Color*)data;
+    for (int i = 0; i < 256; i++) {
+        MiyooPalette[i] = rgb565(colors[i].r, colors[i].g, colors[i].b);
+    }
+    PresentAllRows = true;
     // Also set on the surface palette (needed for any SDL blit paths)
     SDL_SetPaletteColors(SDLSurfacePaletted->format->palette, (const SDL_Color*)data, 0, 256);
+    if (SDLSurfacePresenting) {
+        SDL_SetPaletteColors(SDLSurfacePresenting->format->palette, (const SDL_Color*)data, 0,
+                             256);
+    }
 #else
     if (EolSettings->renderer() == RendererType::OpenGL) {
         gl_update_palette(data);
@@ -60,8 +60,9 @@ void polygon::render_one_line(int v, bool forward, bool dotted) const {
 }
 
 void polygon::render_outline() {
-    if (vertex_count < 3 || vertex_count > MAX_VERTICES) {
-        internal_error("polygon::render_outline vertex_count < 3 || vertex_count > MAX_VERTICES!");
+    if (vertex_count < 3 || vertex_count > max_vertices()) {
+        internal_error(
+            "polygon::render_outline vertex_count < 3 || vertex_count > max_vertices()!");
     }
     for (int i = 0; i < vertex_count; i++) {
         render_one_line(i, true, false);
@@ -69,7 +70,7 @@ void polygon::render_outline() {
 }
 
 bool polygon::insert_vertex(int v) {
-    if (vertex_count + 1 > MAX_VERTICES) {
+    if (vertex_count + 1 > max_vertices()) {
         dialog("You cannot add more points to this polygon!");
         return false;
     }
@@ -267,8 +268,8 @@ polygon::polygon(FILE* h, int version) {
     if (fread(&vertex_count, 1, sizeof(vertex_count), h) != 4) {
         internal_error("polygon::polygon: Failed to read file!");
     }
-    if (vertex_count < 3 || vertex_count > MAX_VERTICES) {
-        internal_error("polygon::polygon vertex_count < 3 || vertex_count > MAX_VERTICES!");
+    if (vertex_count < 3 || vertex_count > max_vertices()) {
+        internal_error("polygon::polygon vertex_count < 3 || vertex_count > max_vertices()!");
     }
     allocated_vertex_count = vertex_count + 10;
     vertices = new vect2[allocated_vertex_count];
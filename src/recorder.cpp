@@ -1,4 +1,5 @@
 #include "recorder.h"
+#include "eol_settings.h"
 #include "flagtag.h"
 #include "fs_utils.h"
 #include "level.h"
@@ -6,7 +7,11 @@
 #include "physics_init.h"
 #include "platform_utils.h"
 #include "qopen.h"
+#include "timer.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <sys/stat.h>
 
@@ -16,6 +21,13 @@ int MultiplayerRec = 0;
 
 constexpr int MAGIC_NUMBER = 4796277;
 
+// Version of the original game, with raw frame columns
+constexpr int VERSION = 131;
+// Same, but the frame columns are packed, see encode_column()
+constexpr int VERSION_COMPRESSED = 132;
+// Upper bound of the packed frame block, every value escaped and a block header for each
+constexpr int MAX_PACKED_LENGTH_PER_FRAME = 14 * 9;
+
 constexpr int FRAME_RATE = 30;
 constexpr double TIME_TO_FRAME_INDEX = FRAME_RATE / (STOPWATCH_MULTIPLIER * 1000.0 * 0.0024);
 constexpr double FRAME_INDEX_TO_TIME = 1.0 / TIME_TO_FRAME_INDEX;
@@ -36,6 +48,11 @@ recorder::recorder() {
     event_count = 0;
     flagtag_ = 0;
     level_filename[0] = 0;
+    finished = false;
+    previous_frame_time = 0.0;
+    next_frame_time = 0.0;
+    next_frame_index = 0;
+    current_event_index = 0;
 
     frames.reserve(INITIAL_FRAMES);
     events.reserve(INITIAL_EVENTS);
@@ -344,6 +361,29 @@ void recorder::store_event(double time, WavEvent event_id, double volume, int ob
     event_count++;
 }
 
+recorder_position recorder::store_position() const {
+    recorder_position position;
+    position.frame_count = frame_count;
+    position.event_count = event_count;
+    position.next_frame_index = next_frame_index;
+    position.previous_bike_r = previous_bike_r;
+    position.previous_frame_time = previous_frame_time;
+    position.next_frame_time = next_frame_time;
+    return position;
+}
+
+void recorder::set_store_position(const recorder_position& position) {
+    if (position.frame_count > frame_count || position.event_count > event_count) {
+        internal_error("recorder::set_store_position past the end of the recording!");
+    }
+    frame_count = position.frame_count;
+    event_count = position.event_count;
+    next_frame_index = position.next_frame_index;
+    previous_bike_r = position.previous_bike_r;
+    previous_frame_time = position.previous_frame_time;
+    next_frame_time = position.next_frame_time;
+}
+
 bool recorder::recall_event(double time, WavEvent* event_id, double* volume, int* object_id) {
     if (current_event_index < event_count) {
         if (events[current_event_index].time <= time) {
@@ -357,99 +397,348 @@ bool recorder::recall_event(double time, WavEvent* event_id, double* volume, int
     return false;
 }
 
-static void read_error(const char* filename) {
-    internal_error("Failed to read rec file: ", filename);
+void recorder::set_recall_position(int event_index) {
+    if (event_index < 0 || event_index > event_count) {
+        internal_error("recorder::set_recall_position event_index out of range!");
+    }
+    current_event_index = event_index;
+    finished = false;
 }
 
-int recorder::load(const char* filename, FILE* h, int demo, bool is_first_replay) {
+double recorder::frame_time(int frame_index) { return frame_index * FRAME_INDEX_TO_TIME; }
+
+// Bits of the compressed frame block, least significant bit first
+class bit_writer {
+    uint64_t pending = 0;
+    int pending_bits = 0;
+
+  public:
+    std::vector<unsigned char> bytes;
+
+    void write(uint32_t value, int bits) {
+        pending |= (uint64_t)value << pending_bits;
+        pending_bits += bits;
+        while (pending_bits >= 8) {
+            bytes.push_back((unsigned char)pending);
+            pending >>= 8;
+            pending_bits -= 8;
+        }
+    }
+    void flush() {
+        if (pending_bits > 0) {
+            write(0, 8 - pending_bits);
+        }
+    }
+};
+
+// Number of one bits at the bottom of each byte
+static constexpr std::array<unsigned char, 256> TRAILING_ONES = [] {
+    std::array<unsigned char, 256> table{};
+    for (int byte = 0; byte < 256; byte++) {
+        while (byte >> table[byte] & 1) {
+            table[byte]++;
+        }
+    }
+    return table;
+}();
+
+class bit_reader {
+    const unsigned char* p;
+    const unsigned char* end;
+    uint64_t pending = 0;
+    int pending_bits = 0;
+
+    void refill() {
+        while (pending_bits <= 56 && p < end) {
+            pending |= (uint64_t)*p++ << pending_bits;
+            pending_bits += 8;
+        }
+    }
+    void skip(int bits) {
+        pending >>= bits;
+        pending_bits -= bits;
+    }
+
+  public:
+    bit_reader(const unsigned char* data, int length) : p(data), end(data + length) {}
+
+    // Return false if the data has ended
+    bool read(uint32_t* value, int bits) {
+        if (pending_bits < bits) {
+            refill();
+            if (pending_bits < bits) {
+                return false;
+            }
+        }
+        *value = (uint32_t)(pending & ((1ull << bits) - 1));
+        skip(bits);
+        return true;
+    }
+    // Count one bits up to a zero bit, which is skipped, or up to `limit` one bits
+    bool read_unary(uint32_t* count, uint32_t limit) {
+        *count = 0;
+        while (true) {
+            if (pending_bits < 8) {
+                refill();
+                if (pending_bits == 0) {
+                    return false;
+                }
+            }
+            // Bits above pending_bits are zero, so ones <= pending_bits:
+            int ones = TRAILING_ONES[pending & 0xff];
+            if (*count + ones >= limit) {
+                skip(limit - *count);
+                *count = limit;
+                return true;
+            }
+            *count += ones;
+            if (ones < 8 && ones < pending_bits) {
+                skip(ones + 1);
+                return true;
+            }
+            skip(ones);
+        }
+    }
+    bool at_end() const { return p == end && pending == 0; }
+};
+
+// Values of a column share one Rice parameter per block:
+constexpr int RICE_BLOCK = 64;
+// Longer unary quotients are written as 32 raw bits instead:
+constexpr int RICE_ESCAPE = 32;
+
+static int rice_length(uint32_t value, int k) {
+    uint32_t quotient = value >> k;
+    if (quotient >= RICE_ESCAPE) {
+        return RICE_ESCAPE + 32;
+    }
+    return quotient + 1 + k;
+}
+
+// Packs one field of all frames. The field is read as a little-endian integer of its size (the
+// bit pattern for floats) and predicted from the previous frame, or with `smooth` linearly from
+// the previous two. The prediction error is zigzag encoded and Rice coded: most errors are a
+// few bits, so a frame takes about half of its 28 bytes. Wrapping arithmetic keeps it lossless.
+static void encode_column(bit_writer* packed, const unsigned char* field, int count,
+                          size_t field_size, bool smooth) {
+    int shift = 32 - 8 * field_size;
+    std::vector<uint32_t> errors(count);
+    uint32_t previous1 = 0;
+    uint32_t previous2 = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t value = 0;
+        memcpy(&value, field + i * sizeof(frame_data), field_size);
+        uint32_t prediction = smooth ? 2 * previous1 - previous2 : previous1;
+        // Error sign extended from the field size:
+        int32_t error = (int32_t)((value - prediction) << shift) >> shift;
+        errors[i] = ((uint32_t)error << 1) ^ (uint32_t)(error >> 31);
+        previous2 = previous1;
+        previous1 = value;
+    }
+
+    for (int block = 0; block < count; block += RICE_BLOCK) {
+        int block_end = std::min(block + RICE_BLOCK, count);
+        int best_k = 0;
+        int best_length = -1;
+        for (int k = 0; k < 32; k++) {
+            int length = 0;
+            for (int i = block; i < block_end; i++) {
+                length += rice_length(errors[i], k);
+            }
+            if (best_length < 0 || length < best_length) {
+                best_k = k;
+                best_length = length;
+            }
+        }
+
+        packed->write(best_k, 5);
+        for (int i = block; i < block_end; i++) {
+            uint32_t quotient = errors[i] >> best_k;
+            if (quotient >= RICE_ESCAPE) {
+                packed->write(0xffffffff, RICE_ESCAPE);
+                packed->write(errors[i], 32);
+                continue;
+            }
+            packed->write((1u << quotient) - 1, quotient + 1);
+            if (best_k > 0) {
+                packed->write(errors[i] & ((1u << best_k) - 1), best_k);
+            }
+        }
+    }
+}
+
+// Unpacks a column written by encode_column(), return false if the packed data ends too early
+static bool decode_column(bit_reader* packed, unsigned char* field, int count, size_t field_size,
+                          bool smooth) {
+    uint32_t mask = field_size == 4 ? 0xffffffff : (1u << (8 * field_size)) - 1;
+    uint32_t previous1 = 0;
+    uint32_t previous2 = 0;
+    uint32_t k = 0;
+    for (int i = 0; i < count; i++) {
+        if (i % RICE_BLOCK == 0 && !packed->read(&k, 5)) {
+            return false;
+        }
+
+        uint32_t quotient = 0;
+        if (!packed->read_unary(&quotient, RICE_ESCAPE)) {
+            return false;
+        }
+        uint32_t zigzag = 0;
+        if (quotient == RICE_ESCAPE) {
+            if (!packed->read(&zigzag, 32)) {
+                return false;
+            }
+        } else {
+            uint32_t remainder = 0;
+            if (k > 0 && !packed->read(&remainder, k)) {
+                return false;
+            }
+            zigzag = quotient << k | remainder;
+        }
+
+        uint32_t error = (zigzag >> 1) ^ -(zigzag & 1);
+        uint32_t prediction = smooth ? 2 * previous1 - previous2 : previous1;
+        uint32_t value = (prediction + error) & mask;
+        memcpy(field + i * sizeof(frame_data), &value, field_size);
+        previous2 = previous1;
+        previous1 = value;
+    }
+    return true;
+}
+
+bool recorder::load(const char* filename, FILE* h, int demo, bool is_first_replay, int* level_id) {
     frame_count = 0;
     if (fread(&frame_count, 1, sizeof(frame_count), h) != 4) {
-        read_error(filename);
+        return false;
     }
     if (frame_count <= 0) {
-        internal_error("recorder frame_count <= 0: ", filename);
+        return false;
     }
 
     frames.resize(frame_count);
 
     int version = 0;
     if (fread(&version, 1, sizeof(version), h) != 4) {
-        read_error(filename);
+        return false;
     }
-    if (version < 131) {
+    if (version < VERSION) {
         external_error("Rec file version is too old!", filename);
     }
-    if (version > 131) {
+    if (version > VERSION_COMPRESSED) {
         external_error("Rec file version is too new!", filename);
     }
 
     int multiplayer_rec = 0;
     if (fread(&multiplayer_rec, 1, sizeof(multiplayer_rec), h) != 4) {
-        read_error(filename);
+        return false;
     }
     if (is_first_replay) {
         MultiplayerRec = multiplayer_rec;
     }
     if (fread(&flagtag_, 1, sizeof(flagtag_), h) != 4) {
-        read_error(filename);
+        return false;
     }
 
-    int level_id = 0;
-    if (fread(&level_id, 1, sizeof(level_id), h) != 4) {
-        read_error(filename);
+    if (fread(level_id, 1, sizeof(*level_id), h) != 4) {
+        return false;
     }
     if (fread(level_filename, 1, 16, h) != 16) {
-        read_error(filename);
+        return false;
     }
 
+    if (version == VERSION_COMPRESSED) {
+        int packed_length = 0;
+        if (fread(&packed_length, 1, sizeof(packed_length), h) != 4) {
+            return false;
+        }
+        if (packed_length <= 0 ||
+            packed_length > (long long)frame_count * MAX_PACKED_LENGTH_PER_FRAME) {
+            return false;
+        }
+        std::vector<unsigned char> packed(packed_length);
+        if (fread(packed.data(), 1, packed_length, h) != packed_length) {
+            return false;
+        }
+        bit_reader reader(packed.data(), packed_length);
+#define DECODE_FIELD(field, smooth)                                                                \
+    {                                                                                              \
+        if (!decode_column(&reader, (unsigned char*)&frames[0].field, frame_count,                 \
+                           sizeof(frames[0].field), smooth)) {                                     \
+            return false;                                                                  \
+        }                                                                                          \
+    }
+        DECODE_FIELD(bike_x, true);
+        DECODE_FIELD(bike_y, true);
+        DECODE_FIELD(left_wheel_x, true);
+        DECODE_FIELD(left_wheel_y, true);
+        DECODE_FIELD(right_wheel_x, true);
+        DECODE_FIELD(right_wheel_y, true);
+        DECODE_FIELD(body_x, true);
+        DECODE_FIELD(body_y, true);
+        DECODE_FIELD(bike_rotation, true);
+        DECODE_FIELD(left_wheel_rotation, true);
+        DECODE_FIELD(right_wheel_rotation, true);
+        DECODE_FIELD(flags, false);
+        DECODE_FIELD(motor_frequency, false);
+        DECODE_FIELD(friction_volume, false);
+#undef DECODE_FIELD
+        if (!reader.at_end()) {
+            return false;
+        }
+    } else {
+        // The file stores one column per field, each column is read with a single fread:
+        std::vector<unsigned char> column(frame_count * sizeof(float));
 #define READ_FIELD(field)                                                                          \
     {                                                                                              \
+        size_t field_size = sizeof(frames[0].field);                                               \
+        size_t column_length = frame_count * field_size;                                           \
+        if (fread(column.data(), 1, column_length, h) != column_length) {                          \
+            return false;                                                                  \
+        }                                                                                          \
         for (int i = 0; i < frame_count; i++) {                                                    \
-            if (fread(&frames[i].field, 1, sizeof(frames[i].field), h) !=                          \
-                sizeof(frames[i].field)) {                                                         \
-                read_error(filename);                                                              \
-            }                                                                                      \
+            memcpy(&frames[i].field, &column[i * field_size], field_size);                         \
         }                                                                                          \
     }
-    READ_FIELD(bike_x);
-    READ_FIELD(bike_y);
-    READ_FIELD(left_wheel_x);
-    READ_FIELD(left_wheel_y);
-    READ_FIELD(right_wheel_x);
-    READ_FIELD(right_wheel_y);
-    READ_FIELD(body_x);
-    READ_FIELD(body_y);
-    READ_FIELD(bike_rotation);
-    READ_FIELD(left_wheel_rotation);
-    READ_FIELD(right_wheel_rotation);
-    READ_FIELD(flags);
-    READ_FIELD(motor_frequency);
-    READ_FIELD(friction_volume);
+        READ_FIELD(bike_x);
+        READ_FIELD(bike_y);
+        READ_FIELD(left_wheel_x);
+        READ_FIELD(left_wheel_y);
+        READ_FIELD(right_wheel_x);
+        READ_FIELD(right_wheel_y);
+        READ_FIELD(body_x);
+        READ_FIELD(body_y);
+        READ_FIELD(bike_rotation);
+        READ_FIELD(left_wheel_rotation);
+        READ_FIELD(right_wheel_rotation);
+        READ_FIELD(flags);
+        READ_FIELD(motor_frequency);
+        READ_FIELD(friction_volume);
 #undef READ_FIELD
+    }
 
     if (fread(&event_count, 1, 4, h) != 4) {
-        read_error(filename);
+        return false;
     }
     if (event_count < 0) {
-        internal_error("recorder event_count < 0!");
+        return false;
     }
 
     events.resize(event_count);
 
     int event_length = event_count * sizeof(event);
     if (fread(events.data(), 1, event_length, h) != event_length) {
-        read_error(filename);
+        return false;
     }
 
     int magic_number = 0;
     if (fread(&magic_number, 1, sizeof(magic_number), h) != 4) {
-        read_error(filename);
+        return false;
     }
     if (magic_number != MAGIC_NUMBER) {
-        internal_error("magic_number != MAGIC_NUMBER");
+        return false;
     }
 
-    return level_id;
+    return true;
 }
 
 static void save_error(const char* filename) {
@@ -481,7 +770,8 @@ void recorder::save(const char* filename, FILE* h, int level_id, int flagtag) {
     if (fwrite(&frame_count, 1, sizeof(frame_count), h) != 4) {
         save_error(filename);
     }
-    int version = 131;
+    bool compress = EolSettings->compress_replays();
+    int version = compress ? VERSION_COMPRESSED : VERSION;
     if (fwrite(&version, 1, sizeof(version), h) != 4) {
         save_error(filename);
     }
@@ -498,30 +788,64 @@ void recorder::save(const char* filename, FILE* h, int level_id, int flagtag) {
         save_error(filename);
     }
 
+    if (compress) {
+        // Positions and rotations change smoothly, flags and sounds jump between values:
+        bit_writer packed;
+#define ENCODE_FIELD(field, smooth)                                                                \
+    encode_column(&packed, (const unsigned char*)&frames[0].field, frame_count,                    \
+                  sizeof(frames[0].field), smooth)
+        ENCODE_FIELD(bike_x, true);
+        ENCODE_FIELD(bike_y, true);
+        ENCODE_FIELD(left_wheel_x, true);
+        ENCODE_FIELD(left_wheel_y, true);
+        ENCODE_FIELD(right_wheel_x, true);
+        ENCODE_FIELD(right_wheel_y, true);
+        ENCODE_FIELD(body_x, true);
+        ENCODE_FIELD(body_y, true);
+        ENCODE_FIELD(bike_rotation, true);
+        ENCODE_FIELD(left_wheel_rotation, true);
+        ENCODE_FIELD(right_wheel_rotation, true);
+        ENCODE_FIELD(flags, false);
+        ENCODE_FIELD(motor_frequency, false);
+        ENCODE_FIELD(friction_volume, false);
+#undef ENCODE_FIELD
+        packed.flush();
+        int packed_length = packed.bytes.size();
+        if (fwrite(&packed_length, 1, sizeof(packed_length), h) != 4) {
+            save_error(filename);
+        }
+        if (fwrite(packed.bytes.data(), 1, packed_length, h) != packed_length) {
+            save_error(filename);
+        }
+    } else {
+        std::vector<unsigned char> column(frame_count * sizeof(float));
 #define WRITE_FIELD(field)                                                                         \
     {                                                                                              \
+        size_t field_size = sizeof(frames[0].field);                                               \
+        size_t column_length = frame_count * field_size;                                           \
         for (int i = 0; i < frame_count; i++) {                                                    \
-            if (fwrite(&frames[i].field, 1, sizeof(frames[i].field), h) !=                         \
-                sizeof(frames[i].field)) {                                                         \
-                save_error(filename);                                                              \
-            }                                                                                      \
+            memcpy(&column[i * field_size], &frames[i].field, field_size);                         \
+        }                                                                                          \
+        if (fwrite(column.data(), 1, column_length, h) != column_length) {                         \
+            save_error(filename);                                                                  \
         }                                                                                          \
     }
-    WRITE_FIELD(bike_x);
-    WRITE_FIELD(bike_y);
-    WRITE_FIELD(left_wheel_x);
-    WRITE_FIELD(left_wheel_y);
-    WRITE_FIELD(right_wheel_x);
-    WRITE_FIELD(right_wheel_y);
-    WRITE_FIELD(body_x);
-    WRITE_FIELD(body_y);
-    WRITE_FIELD(bike_rotation);
-    WRITE_FIELD(left_wheel_rotation);
-    WRITE_FIELD(right_wheel_rotation);
-    WRITE_FIELD(flags);
-    WRITE_FIELD(motor_frequency);
-    WRITE_FIELD(friction_volume);
+        WRITE_FIELD(bike_x);
+        WRITE_FIELD(bike_y);
+        WRITE_FIELD(left_wheel_x);
+        WRITE_FIELD(left_wheel_y);
+        WRITE_FIELD(right_wheel_x);
+        WRITE_FIELD(right_wheel_y);
+        WRITE_FIELD(body_x);
+        WRITE_FIELD(body_y);
+        WRITE_FIELD(bike_rotation);
+        WRITE_FIELD(left_wheel_rotation);
+        WRITE_FIELD(right_wheel_rotation);
+        WRITE_FIELD(flags);
+        WRITE_FIELD(motor_frequency);
+        WRITE_FIELD(friction_volume);
 #undef WRITE_FIELD
+    }
 
     if (fwrite(&event_count, 1, 4, h) != 4) {
         save_error(filename);
@@ -541,7 +865,7 @@ void recorder::save(const char* filename, FILE* h, int level_id, int flagtag) {
     }
 }
 
-int recorder::load_rec_file(const char* filename, int demo) {
+bool recorder::load_rec_file(const char* filename, int demo, int* level_id) {
     FILE* h = nullptr;
     if (demo) {
         h = qopen(filename, "rb");
@@ -557,9 +881,10 @@ int recorder::load_rec_file(const char* filename, int demo) {
         }
     }
 
-    int level_id = Rec1->load(filename, h, demo, true);
-    if (MultiplayerRec) {
-        Rec2->load(filename, h, demo, false);
+    bool ok = Rec1->load(filename, h, demo, true, level_id);
+    if (ok && MultiplayerRec) {
+        int level_id_b = 0;
+        ok = Rec2->load(filename, h, demo, false, &level_id_b);
     }
 
     if (demo) {
@@ -568,7 +893,93 @@ int recorder::load_rec_file(const char* filename, int demo) {
         fclose(h);
     }
 
-    return level_id;
+    if (!ok) {
+        // Nothing of the damaged file may be played
+        char no_level[] = "";
+        Rec1->erase(no_level);
+        Rec2->erase(no_level);
+        MultiplayerRec = 0;
+    }
+    return ok;
+}
+
+// Reads the header and events of one bike and skips its frames, return false on a bad file
+static bool read_bike_info(FILE* h, replay_info* info, bool is_first) {
+    int frame_count = 0;
+    int version = 0;
+    int multiplayer_rec = 0;
+    int flagtag = 0;
+    int level_id = 0;
+    char level_filename[16];
+    if (fread(&frame_count, 1, sizeof(frame_count), h) != 4 || frame_count <= 0 ||
+        fread(&version, 1, sizeof(version), h) != 4 ||
+        (version != VERSION && version != VERSION_COMPRESSED) ||
+        fread(&multiplayer_rec, 1, sizeof(multiplayer_rec), h) != 4 ||
+        fread(&flagtag, 1, sizeof(flagtag), h) != 4 ||
+        fread(&level_id, 1, sizeof(level_id), h) != 4 ||
+        fread(level_filename, 1, 16, h) != 16) {
+        return false;
+    }
+    if (is_first) {
+        memcpy(info->level_filename, level_filename, sizeof(level_filename));
+        info->level_filename[sizeof(level_filename) - 1] = 0;
+        info->level_id = level_id;
+        info->multiplayer = multiplayer_rec;
+        info->flagtag = flagtag;
+    }
+    if (frame_count > info->frame_count) {
+        info->frame_count = frame_count;
+    }
+
+    // The columns hold the fields without the padding of frame_data:
+    long frames_length = (long)frame_count * 27;
+    if (version == VERSION_COMPRESSED) {
+        int packed_length = 0;
+        if (fread(&packed_length, 1, sizeof(packed_length), h) != 4 || packed_length <= 0 ||
+            packed_length > (long long)frame_count * MAX_PACKED_LENGTH_PER_FRAME) {
+            return false;
+        }
+        frames_length = packed_length;
+    }
+    int event_count = 0;
+    if (fseek(h, frames_length, SEEK_CUR) != 0 ||
+        fread(&event_count, 1, sizeof(event_count), h) != 4 || event_count < 0) {
+        return false;
+    }
+    if (event_count > 0) {
+        event last;
+        if (fseek(h, (long)(event_count - 1) * sizeof(event), SEEK_CUR) != 0 ||
+            fread(&last, 1, sizeof(last), h) != sizeof(last)) {
+            return false;
+        }
+        // A finish ends the recording, an abandoned run goes on after its last touch:
+        double last_frame = last.time * TIME_TO_FRAME_INDEX;
+        if (last.object_id >= 0 && fabs(last_frame - frame_count) <= 1.0) {
+            long time = last.time * TimeToCentiseconds;
+            if (time > info->finish_time) {
+                info->finish_time = time;
+            }
+        }
+    }
+    int magic_number = 0;
+    return fread(&magic_number, 1, sizeof(magic_number), h) == 4 && magic_number == MAGIC_NUMBER;
+}
+
+bool recorder::read_info(const char* filename, replay_info* info) {
+    char path[40];
+    snprintf(path, sizeof(path), "rec/%s", filename);
+    FILE* h = fopen(path, "rb");
+    if (!h) {
+        return false;
+    }
+    info->frame_count = 0;
+    info->finish_time = -1;
+    bool ok = read_bike_info(h, info, true);
+    if (ok && info->multiplayer) {
+        ok = read_bike_info(h, info, false);
+    }
+    fclose(h);
+    return ok;
 }
 
 void recorder::save_rec_file(const char* filename, int level_id, int flagtag) {
@@ -587,37 +998,3 @@ void recorder::save_rec_file(const char* filename, int level_id, int flagtag) {
         Rec1->save(filename, nullptr, level_id, flagtag);
     }
 }
-
-// Max events in one frame: Triple apple bug x MAX_OBJECTS, turn, volt, bump x 2
-constexpr int EVENT_BUFFER_MAX = MAX_OBJECTS * 3 + 100;
-static int EventBufferLength = 0;
-static WavEvent EventBufferEventIds[EVENT_BUFFER_MAX];
-static double EventBufferVolumes[EVENT_BUFFER_MAX];
-static int EventBufferObjectIds[EVENT_BUFFER_MAX];
-
-void add_event_buffer(WavEvent event_id, double volume, int object_id) {
-    if (EventBufferLength < EVENT_BUFFER_MAX) {
-        EventBufferEventIds[EventBufferLength] = event_id;
-        EventBufferVolumes[EventBufferLength] = volume;
-        EventBufferObjectIds[EventBufferLength] = object_id;
-        EventBufferLength++;
-    }
-}
-
-void reset_event_buffer() { EventBufferLength = 0; }
-
-bool get_event_buffer(WavEvent* event_id, double* volume, int* object_id) {
-    if (EventBufferLength == 0) {
-        return false;
-    }
-    *event_id = EventBufferEventIds[0];
-    *volume = EventBufferVolumes[0];
-    *object_id = EventBufferObjectIds[0];
-    EventBufferLength--;
-    for (int i = 0; i < EventBufferLength; i++) {
-        EventBufferEventIds[i] = EventBufferEventIds[i + 1];
-        EventBufferVolumes[i] = EventBufferVolumes[i + 1];
-        EventBufferObjectIds[i] = EventBufferObjectIds[i + 1];
-    }
-    return true;
-}
@@ -41,6 +41,30 @@ struct frame_data {
 };
 static_assert(sizeof(frame_data) == 28);
 
+// What the header and the events of a replay file tell without loading the frames
+struct replay_info {
+    char level_filename[16];
+    int level_id;
+    bool multiplayer;
+    bool flagtag;
+    // Of the longer bike
+    int frame_count;
+    // Centiseconds, -1 if not finished. Like other replay tools, a replay counts as finished if
+    // a bike's last event is an object touch within one frame of its last frame; touching a
+    // killer last cannot be told apart.
+    long finish_time;
+};
+
+// Where store_frames() and store_event() continue writing
+struct recorder_position {
+    int frame_count;
+    int event_count;
+    int next_frame_index;
+    vect2 previous_bike_r;
+    double previous_frame_time;
+    double next_frame_time;
+};
+
 class recorder {
     friend void replay();
 
@@ -61,8 +85,8 @@ class recorder {
 
     int flagtag_;
 
-    // Load replay of one bike
-    int load(const char* filename, FILE* h, int demo, bool is_first_replay);
+    // Load replay of one bike, return false on a damaged file
+    bool load(const char* filename, FILE* h, int demo, bool is_first_replay, int* level_id);
     // Save replay of one bike
     void save(const char* filename, FILE* h, int level_id, int flagtag);
 
@@ -72,10 +96,14 @@ class recorder {
     recorder();
     ~recorder();
 
-    // Load a singleplayer or multiplayer replay
-    static int load_rec_file(const char* filename, int demo);
+    // Load a singleplayer or multiplayer replay, return false if the file is damaged. The
+    // recorders are then left empty
+    static bool load_rec_file(const char* filename, int demo, int* level_id);
     // Save a singleplayer or multiplayer replay
     static void save_rec_file(const char* filename, int level_id, int flagtag);
+    // Read the replay_info of rec/`filename`, return false if it is not a valid replay.
+    // Touches no global state, so any thread can call it
+    static bool read_info(const char* filename, replay_info* info);
 
     bool is_empty() { return frame_count == 0; }
     void erase(char* lev_filename);
@@ -84,8 +112,17 @@ class recorder {
     void store_frames(motorst* mot, double time, bike_sound* sound);
 
     void store_event(double time, WavEvent event_id, double volume, int object_id);
+    recorder_position store_position() const;
+    // Continue recording from an earlier position, dropping what was stored after it
+    void set_store_position(const recorder_position& position);
     // Return true if a new event has occurred
     bool recall_event(double time, WavEvent* event_id, double* volume, int* object_id);
+    // Where recall_event() continues, for seeking in a replay
+    int recall_position() const { return current_event_index; }
+    // Continue recalling from an earlier recall_position(), also after the end of the replay
+    void set_recall_position(int event_index);
+    // Replay time of frame `frame_index`
+    static double frame_time(int frame_index);
 
     bool flagtag();
     void set_flagtag(bool flagtag);
@@ -100,9 +137,4 @@ extern recorder* Rec1;
 extern recorder* Rec2;
 extern int MultiplayerRec;
 
-void add_event_buffer(WavEvent event_id, double volume, int object_id);
-void reset_event_buffer();
-// Return true if a new event has been obtained
-bool get_event_buffer(WavEvent* event_id, double* volume, int* object_id);
-
 #endif
@@ -0,0 +1,5 @@
+#include "render_profile.h"
+
+bool RenderProfiling = false;
+std::atomic<long long> RenderStageNanoseconds[(int)RenderStage::Count];
+void (*RenderFrameHook)() = nullptr;
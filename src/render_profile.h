@@ -0,0 +1,46 @@
+#ifndef RENDER_PROFILE_H
+#define RENDER_PROFILE_H
+
+#include <atomic>
+#include <chrono>
+
+// Stages of kirajzol320, timed when RenderProfiling is set (bench_render)
+enum class RenderStage {
+    Ground,     // Pecsetalso->kitesz
+    Objects,    // Food, exit and killer blits
+    Bikes,      // kibike
+    Foreground, // Pecsetfelso->kitesz
+    View,       // kiview
+    Timers,     // draw_timers
+    Present,    // unlockbackbuffer_pic
+    Count
+};
+
+extern bool RenderProfiling;
+// Nanoseconds spent in each stage, summed over all render threads
+extern std::atomic<long long> RenderStageNanoseconds[(int)RenderStage::Count];
+// Called by kirajzol320 after each frame, once its present time has been added, when set
+extern void (*RenderFrameHook)();
+
+// Adds the lifetime of the scope to its stage
+class render_stage_scope {
+    RenderStage stage;
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    explicit render_stage_scope(RenderStage s) : stage(s), enabled(RenderProfiling) {
+        if (enabled) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~render_stage_scope() {
+        if (enabled) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            RenderStageNanoseconds[(int)stage] +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "replay_index.h"
+#include "main.h"
+#include "recorder.h"
+#include <algorithm>
+
+void replay_index::add(world* wld, int frame_index) {
+    if (!keyframes.empty() && keyframes.back().frame_index >= frame_index) {
+        internal_error("replay_index::add keyframes out of order!");
+    }
+    keyframes.emplace_back();
+    keyframe& key = keyframes.back();
+    key.frame_index = frame_index;
+    key.event_index1 = wld->rec1->recall_position();
+    key.event_index2 = wld->rec2->recall_position();
+    wld->snapshot(&key.state, recorder::frame_time(frame_index));
+}
+
+int replay_index::restore(world* wld, double time) const {
+    if (keyframes.empty()) {
+        internal_error("replay_index::restore no keyframes!");
+    }
+    // First keyframe after `time`, the one before it is the one to restore
+    auto after = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                  [](double t, const keyframe& key) {
+                                      return t < recorder::frame_time(key.frame_index);
+                                  });
+    if (after != keyframes.begin()) {
+        after--;
+    }
+    const keyframe& key = *after;
+    wld->restore(key.state);
+    wld->rec1->set_recall_position(key.event_index1);
+    wld->rec2->set_recall_position(key.event_index2);
+    return key.frame_index;
+}
@@ -0,0 +1,34 @@
+#ifndef REPLAY_INDEX_H
+#define REPLAY_INDEX_H
+
+#include "world.h"
+#include <vector>
+
+// Frames between two keyframes, one second of replay
+constexpr int REPLAY_KEYFRAME_FRAMES = 30;
+
+// Keyframes of the replay being viewed, taken while playing it through silently once.
+// Seeking finds the last keyframe before the target with a binary search and restores it, then
+// only the frames after that keyframe have to be played through again.
+class replay_index {
+    struct keyframe {
+        int frame_index;
+        // recall_position() of both recorders
+        int event_index1;
+        int event_index2;
+        // Eaten apples, gravity and the flag tag state
+        world_snapshot state;
+    };
+    std::vector<keyframe> keyframes;
+
+  public:
+    void clear() { keyframes.clear(); }
+    bool empty() const { return keyframes.empty(); }
+    // Add the state of `wld` before frame `frame_index` is played, after the previous keyframes
+    void add(world* wld, int frame_index);
+    // Return `wld` and its recorders to the last keyframe at or before `time` and return the
+    // frame index of that keyframe, the first frame to play again
+    int restore(world* wld, double time) const;
+};
+
+#endif
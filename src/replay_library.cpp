@@ -0,0 +1,194 @@
+#include "replay_library.h"
+#include "fs_utils.h"
+#include "platform_utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
+replay_library* ReplayLibrary = nullptr;
+
+static const char INDEX_FILENAME[] = "rec/replays.idx";
+// Raised when replay_info or how it is read changes
+constexpr int INDEX_VERSION = 3;
+
+// One entry of rec/replays.idx is written field by field with fixed-width types, so that an
+// index written on a PC and copied to the SD card can be read by the device:
+// char filename[16], int64_t modified, int64_t size, int32_t valid, char level_filename[16],
+// int32_t level_id, uint8_t multiplayer, uint8_t flagtag, int32_t frame_count,
+// int64_t finish_time
+constexpr size_t RECORD_SIZE = 16 + 8 + 8 + 4 + 16 + 4 + 1 + 1 + 4 + 8;
+
+template <typename T> static void put(unsigned char*& p, T value) {
+    memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+}
+
+template <typename T> static T get(const unsigned char*& p) {
+    T value;
+    memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return value;
+}
+
+static void write_record(unsigned char* p, const replay_library_entry& entry) {
+    memset(p, 0, 16);
+    strncpy((char*)p, entry.filename.c_str(), 15);
+    p += 16;
+    put<int64_t>(p, entry.modified);
+    put<int64_t>(p, entry.size);
+    put<int32_t>(p, entry.valid);
+    memcpy(p, entry.info.level_filename, 16);
+    p += 16;
+    put<int32_t>(p, entry.info.level_id);
+    put<uint8_t>(p, entry.info.multiplayer);
+    put<uint8_t>(p, entry.info.flagtag);
+    put<int32_t>(p, entry.info.frame_count);
+    put<int64_t>(p, entry.info.finish_time);
+}
+
+static replay_library_entry read_record(const unsigned char* p) {
+    replay_library_entry entry;
+    char filename[16];
+    memcpy(filename, p, 16);
+    filename[15] = 0;
+    p += 16;
+    entry.filename = filename;
+    entry.modified = get<int64_t>(p);
+    entry.size = get<int64_t>(p);
+    entry.valid = get<int32_t>(p) != 0;
+    memset(&entry.info, 0, sizeof(entry.info));
+    memcpy(entry.info.level_filename, p, 16);
+    entry.info.level_filename[15] = 0;
+    p += 16;
+    entry.info.level_id = get<int32_t>(p);
+    entry.info.multiplayer = get<uint8_t>(p) != 0;
+    entry.info.flagtag = get<uint8_t>(p) != 0;
+    entry.info.frame_count = get<int32_t>(p);
+    entry.info.finish_time = (long)get<int64_t>(p);
+    return entry;
+}
+
+replay_library::replay_library() { index_loaded = false; }
+
+replay_library::~replay_library() {
+    if (refresh_thread.joinable()) {
+        refresh_thread.join();
+    }
+}
+
+void replay_library::load_index() {
+    FILE* h = fopen(INDEX_FILENAME, "rb");
+    if (!h) {
+        return;
+    }
+    // A damaged or outdated index is only a cache, it is then rebuilt from the replays
+    int32_t version = 0;
+    int32_t count = 0;
+    if (fread(&version, 1, sizeof(version), h) != 4 || version != INDEX_VERSION ||
+        fread(&count, 1, sizeof(count), h) != 4 || count < 0) {
+        fclose(h);
+        return;
+    }
+    std::vector<unsigned char> records((size_t)count * RECORD_SIZE);
+    if (fread(records.data(), RECORD_SIZE, count, h) != (size_t)count) {
+        fclose(h);
+        return;
+    }
+    fclose(h);
+
+    entries.clear();
+    for (int i = 0; i < count; i++) {
+        entries.push_back(read_record(&records[i * RECORD_SIZE]));
+    }
+}
+
+void replay_library::save_index() const {
+    std::vector<unsigned char> records(entries.size() * RECORD_SIZE);
+    for (size_t i = 0; i < entries.size(); i++) {
+        write_record(&records[i * RECORD_SIZE], entries[i]);
+    }
+
+    FILE* h = fopen(INDEX_FILENAME, "wb");
+    if (!h) {
+        return;
+    }
+    int32_t version = INDEX_VERSION;
+    int32_t count = entries.size();
+    fwrite(&version, 1, sizeof(version), h);
+    fwrite(&count, 1, sizeof(count), h);
+    fwrite(records.data(), RECORD_SIZE, count, h);
+    fclose(h);
+}
+
+// Runs on the refresh thread: no internal_error() and no exceptions
+void replay_library::scan() {
+    if (!index_loaded) {
+        index_loaded = true;
+        load_index();
+    }
+
+    std::unordered_map<std::string, const replay_library_entry*> known;
+    for (const replay_library_entry& entry : entries) {
+        known[entry.filename] = &entry;
+    }
+
+    std::vector<replay_library_entry> scanned;
+    bool changed = false;
+    std::error_code error;
+    std::filesystem::directory_iterator it("rec", error);
+    for (; !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+        const std::filesystem::path& path = it->path();
+        if (!it->is_regular_file(error) ||
+            strcmpi(path.extension().generic_string().c_str(), ".rec") != 0 ||
+            path.stem().generic_string().size() > MAX_FILENAME_LEN) {
+            continue;
+        }
+
+        replay_library_entry entry;
+        entry.filename = path.filename().generic_string();
+        entry.size = it->file_size(error);
+        entry.modified = it->last_write_time(error).time_since_epoch().count();
+        if (error) {
+            continue;
+        }
+
+        auto old = known.find(entry.filename);
+        if (old != known.end() && old->second->modified == entry.modified &&
+            old->second->size == entry.size) {
+            scanned.push_back(*old->second);
+            continue;
+        }
+        memset(&entry.info, 0, sizeof(entry.info));
+        entry.valid = recorder::read_info(entry.filename.c_str(), &entry.info);
+        if (!entry.valid) {
+            memset(&entry.info, 0, sizeof(entry.info));
+            entry.info.finish_time = -1;
+        }
+        scanned.push_back(entry);
+        changed = true;
+    }
+
+    if (scanned.size() != entries.size()) {
+        changed = true;
+    }
+    entries = std::move(scanned);
+    if (changed) {
+        save_index();
+    }
+}
+
+void replay_library::refresh_async() {
+    if (refresh_thread.joinable()) {
+        return;
+    }
+    refresh_thread = std::thread(&replay_library::scan, this);
+}
+
+void replay_library::refresh() {
+    if (refresh_thread.joinable()) {
+        refresh_thread.join();
+    }
+    scan();
+}
@@ -0,0 +1,44 @@
+#ifndef REPLAY_LIBRARY_H
+#define REPLAY_LIBRARY_H
+
+#include "recorder.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+struct replay_library_entry {
+    std::string filename;
+    // Of the file when `info` was read
+    long long modified;
+    long long size;
+    // False if the file is not a valid replay, `info` is then empty
+    bool valid;
+    replay_info info;
+};
+
+// The replays of rec/, with their headers cached in rec/replays.idx. A refresh only reads the
+// files that are new or whose modification time or size changed since the last one.
+class replay_library {
+    std::vector<replay_library_entry> entries;
+    std::thread refresh_thread;
+    bool index_loaded;
+
+    void load_index();
+    void save_index() const;
+    void scan();
+
+  public:
+    replay_library();
+    ~replay_library();
+
+    // Start a refresh on a background thread, so that the replay browser opens without delay
+    void refresh_async();
+    // Finish a background refresh, then pick up changes made since it started
+    void refresh();
+    // The replays in directory order, valid until the next refresh
+    const std::vector<replay_library_entry>& replays() const { return entries; }
+};
+
+extern replay_library* ReplayLibrary;
+
+#endif
@@ -1,38 +1,58 @@
 #include "segments.h"
+#include "eol_settings.h"
 #include "level.h"
 #include "main.h"
+#include "object.h"
 #include "polygon.h"
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
 #include <cstring>
 
-constexpr int MAX_SEGMENTS = MAX_VERTICES;
-
 segments* Segments = nullptr;
 
 segments::segments(level* lev) {
     seg_list = nullptr;
     seg_list_allocated_length = 0;
     seg_list_length = 0;
-    collision_grid = nullptr;
+    cell_start = nullptr;
+    cell_rx = nullptr;
+    cell_ry = nullptr;
+    cell_unit_x = nullptr;
+    cell_unit_y = nullptr;
+    cell_length = nullptr;
     collision_grid_width = 1;
     collision_grid_height = 1;
     collision_grid_cell_size = 1.0;
     collision_grid_origin = vect2(0, 0);
-    collision_grid_iterable = nullptr;
-    node_array = nullptr;
-    node_array_index = 0;
+    counting_cells = false;
+    cell_fill = nullptr;
+    distance_field_block = nullptr;
+    distance_field = nullptr;
+    distance_field_diagonal = 0.0;
+    object_cell_start = nullptr;
+    object_cell_items = nullptr;
+
+    // Count the segments of all solid polygons
+    int segment_count = 0;
+    for (polygon* poly : lev->polygons) {
+        if (poly && !poly->is_grass) {
+            segment_count += poly->vertex_count;
+        }
+    }
+    if (segment_count > max_vertices()) {
+        internal_error("segments::segments segment_count > max_vertices()!");
+    }
 
-    seg_list = new segment[MAX_SEGMENTS];
+    seg_list = new segment[segment_count + 1]();
     if (!seg_list) {
         external_error("segments::segments out of memory!");
         return;
     }
-    memset(seg_list, 0, sizeof(segment) * MAX_SEGMENTS);
-    seg_list_allocated_length = MAX_SEGMENTS;
+    seg_list_allocated_length = segment_count;
 
     // Load all solid polygons
-    for (int i = 0; i < MAX_POLYGONS; i++) {
-        polygon* poly = lev->polygons[i];
+    for (polygon* poly : lev->polygons) {
         if (!poly) {
             continue;
         }
@@ -40,8 +60,8 @@ segments::segments(level* lev) {
             continue;
         }
         for (int j = 0; j < poly->vertex_count; j++) {
-            if (seg_list_length >= MAX_SEGMENTS) {
-                internal_error("segments::segments seg_list_length >= MAX_SEGMENTS!");
+            if (seg_list_length >= seg_list_allocated_length) {
+                internal_error("segments::segments seg_list_length >= seg_list_allocated_length!");
             }
             vect2 r1;
             vect2 r2;
@@ -63,64 +83,29 @@ segments::segments(level* lev) {
 }
 
 segments::~segments() {
-    if (seg_list) {
-        delete seg_list;
-    }
-    if (collision_grid) {
-        delete collision_grid;
-    }
-    delete_all_nodes();
-}
-
-// Get an unused node from memory
-segment_node* segments::new_node() {
-    // No nodes exist, initialize first node
-    if (!node_array) {
-        node_array = new segment_node_array;
-        if (!node_array) {
-            external_error("segments::new_node out of memory!");
-        }
-        node_array->next = nullptr;
-        node_array_index = 0;
-    }
-    // Grab the last memory structure
-    segment_node_array* cur_array = node_array;
-    while (cur_array->next) {
-        cur_array = cur_array->next;
-    }
-    // If we've hit the end of the array in the last memory structure, create a new memory structure
-    if (node_array_index == SEGMENT_NODE_BLOCK_LENGTH) {
-        cur_array->next = new segment_node_array;
-        cur_array = cur_array->next;
-        if (!cur_array) {
-            external_error("segments::new_node out of memory!");
-        }
-        cur_array->next = nullptr;
-        node_array_index = 0;
-    }
-    // Return the new unused node
-    return &cur_array->nodes[node_array_index++];
+    delete[] seg_list;
+    delete[] cell_start;
+    delete[] cell_rx;
+    delete[] cell_ry;
+    delete[] cell_unit_x;
+    delete[] cell_unit_y;
+    delete[] cell_length;
+    delete[] distance_field_block;
+    delete[] distance_field;
+    delete[] object_cell_start;
+    delete[] object_cell_items;
 }
 
-void segments::delete_all_nodes() {
-    segment_node_array* cur_array = node_array;
-    node_array = nullptr;
-    while (cur_array) {
-        segment_node_array* delete_array = cur_array;
-        cur_array = cur_array->next;
-        delete delete_array;
-    }
-}
-
-// collision_grid is a list representing a grid of the map, where each element represents a zone of
+// collision_grid is a grid of the map, where each cell represents a zone of
 // dimensions 1.0x1.0.
 //
-// Each element of collision_grid contains a linked list of all the line
-// segments that cross into this zone.
+// Each cell of collision_grid contains a list of all the line segments that cross into this zone.
+// The lists of all cells are packed one after the other into the cell_ arrays, so cell
+// i = collision_grid_width * cell_y + cell_x owns the items [cell_start[i], cell_start[i + 1]).
 //
-// We create a new segment_node and attach it to:
-// collision_grid[collision_grid_width * cell_y + cell_x]
-void segments::add_node_to_cell(int cell_x, int cell_y, segment* seg) {
+// In the counting pass we only count the segment in cell_start[i + 1], and in the filling pass
+// we store its data at cell_fill[i], the next free item of the cell.
+void segments::add_segment_to_cell(int cell_x, int cell_y, segment* seg) {
 #ifdef DEBUG
     if (cell_x < 0 || cell_y < 0) {
         internal_error("cell_x < 0 || cell_y < 0!");
@@ -129,20 +114,17 @@ void segments::add_node_to_cell(int cell_x, int cell_y, segment* seg) {
     if (cell_x >= collision_grid_width || cell_y >= collision_grid_height) {
         return;
     }
-    // Create a new node for the linked list
-    segment_node* new_n = new_node();
-    new_n->next = nullptr;
-    new_n->seg = seg;
-    // Add the node to the end of the linked list for the selected cell
-    segment_node* cur_n = collision_grid[collision_grid_width * cell_y + cell_x];
-    if (!cur_n) {
-        collision_grid[collision_grid_width * cell_y + cell_x] = new_n;
+    int cell = collision_grid_width * cell_y + cell_x;
+    if (counting_cells) {
+        cell_start[cell + 1]++;
         return;
     }
-    while (cur_n->next) {
-        cur_n = cur_n->next;
-    }
-    cur_n->next = new_n;
+    int index = cell_fill[cell]++;
+    cell_rx[index] = seg->r.x;
+    cell_ry[index] = seg->r.y;
+    cell_unit_x[index] = seg->unit_vector.x;
+    cell_unit_y[index] = seg->unit_vector.y;
+    cell_length[index] = seg->length;
 }
 
 void segments::add_segment_to_collision_grid(segment* seg, double max_radius) {
@@ -224,9 +206,9 @@ void segments::add_segment_to_collision_grid(segment* seg, double max_radius) {
             // Add the segment to all the cells that are crossed at this x position,
             // uninverting the axes if necessary
             if (invert_axes) {
-                add_node_to_cell(cell_y, cell_x, seg);
+                add_segment_to_cell(cell_y, cell_x, seg);
             } else {
-                add_node_to_cell(cell_x, cell_y, seg);
+                add_segment_to_cell(cell_x, cell_y, seg);
             }
             cell_y++;
         }
@@ -241,7 +223,7 @@ void segments::setup_collision_grid(double max_radius) {
     if (seg_list_length <= 0) {
         internal_error("segments::setup_collision_grid no lines!");
     }
-    if (collision_grid) {
+    if (cell_start) {
         internal_error("segments::setup_collision_grid already setup!");
     }
 
@@ -308,33 +290,135 @@ void segments::setup_collision_grid(double max_radius) {
     if (collision_grid_width < 0 || collision_grid_height < 0) {
         internal_error("collision_grid_width < 0 || collision_grid_height < 0!");
     }
-    constexpr int MAX_SIZE = LEVEL_MAX_SIZE + 2 * SEGMENTS_BORDER;
-    if (collision_grid_width > MAX_SIZE || collision_grid_height > MAX_SIZE) {
+    int max_size = EolSettings->extended_levels() ? LEVEL_MAX_SIZE_EXTENDED : LEVEL_MAX_SIZE;
+    max_size += 2 * SEGMENTS_BORDER;
+    if (collision_grid_width > max_size || collision_grid_height > max_size) {
         internal_error("collision_grid_width > MAX_SIZE || collision_grid_height > MAX_SIZE!");
     }
 
-    // Allocate the collision_grid
+    // Count the segments of each cell
     int grid_size = collision_grid_width * collision_grid_height;
-    collision_grid = new psegment_node[grid_size];
-    if (!collision_grid) {
+    cell_start = new int[grid_size + 1];
+    if (!cell_start) {
         external_error("segments::setup_collision_grid out of memory!");
     }
+    for (int i = 0; i <= grid_size; i++) {
+        cell_start[i] = 0;
+    }
+    counting_cells = true;
+    iterate_all_segments();
+    seg = next_segment();
+    while (seg) {
+        add_segment_to_collision_grid(seg, max_radius);
+        seg = next_segment();
+    }
+    counting_cells = false;
     for (int i = 0; i < grid_size; i++) {
-        collision_grid[i] = nullptr;
+        cell_start[i + 1] += cell_start[i];
     }
 
-    // Populate the collision_grid
+    // Allocate the cells, plus one zeroed padding item so the collision code can always load
+    // items in pairs
+    int entry_count = cell_start[grid_size];
+    cell_rx = new double[entry_count + 1];
+    cell_ry = new double[entry_count + 1];
+    cell_unit_x = new double[entry_count + 1];
+    cell_unit_y = new double[entry_count + 1];
+    cell_length = new double[entry_count + 1];
+    cell_fill = new int[grid_size];
+    if (!cell_rx || !cell_ry || !cell_unit_x || !cell_unit_y || !cell_length || !cell_fill) {
+        external_error("segments::setup_collision_grid out of memory!");
+    }
+    cell_rx[entry_count] = 0.0;
+    cell_ry[entry_count] = 0.0;
+    cell_unit_x[entry_count] = 0.0;
+    cell_unit_y[entry_count] = 0.0;
+    cell_length[entry_count] = 0.0;
+    memcpy(cell_fill, cell_start, sizeof(int) * grid_size);
+
+    // Populate the collision_grid, in the same order as the counting pass
     iterate_all_segments();
     seg = next_segment();
     while (seg) {
         add_segment_to_collision_grid(seg, max_radius);
         seg = next_segment();
     }
+    delete[] cell_fill;
+    cell_fill = nullptr;
+
+    setup_distance_field();
+}
+
+// Most collision lookups happen in the air, far from the segments of the cell. The distance field
+// lets get_two_anchor_points() see that without looking at the segments.
+//
+// A position is at most half a diagonal away from the center of its distance field cell, so no
+// item is closer to it than the stored distance minus half a diagonal. get_collision_grid_cell()
+// subtracts a whole diagonal, the other half is a margin that dwarfs any rounding.
+void segments::setup_distance_field() {
+    constexpr int CELL_ITEMS = DISTANCE_FIELD_DIVISIONS * DISTANCE_FIELD_DIVISIONS;
+    int grid_size = collision_grid_width * collision_grid_height;
+    distance_field_block = new int[grid_size];
+    int block_count = 0;
+    for (int i = 0; i < grid_size; i++) {
+        distance_field_block[i] = -1;
+        if (cell_start[i + 1] > cell_start[i]) {
+            distance_field_block[i] = block_count++;
+        }
+    }
+    distance_field = new float[block_count * CELL_ITEMS + 1];
+    if (!distance_field_block || !distance_field) {
+        external_error("segments::setup_distance_field out of memory!");
+    }
+    double field_cell_size = collision_grid_cell_size / DISTANCE_FIELD_DIVISIONS;
+    distance_field_diagonal = field_cell_size * sqrt(2.0);
+
+    for (int cell_y = 0; cell_y < collision_grid_height; cell_y++) {
+        for (int cell_x = 0; cell_x < collision_grid_width; cell_x++) {
+            int cell = collision_grid_width * cell_y + cell_x;
+            if (distance_field_block[cell] < 0) {
+                continue;
+            }
+            float* field = distance_field + distance_field_block[cell] * CELL_ITEMS;
+            for (int sub_y = 0; sub_y < DISTANCE_FIELD_DIVISIONS; sub_y++) {
+                for (int sub_x = 0; sub_x < DISTANCE_FIELD_DIVISIONS; sub_x++) {
+                    vect2 center = collision_grid_origin +
+                                   vect2(cell_x * collision_grid_cell_size +
+                                             (sub_x + 0.5) * field_cell_size,
+                                         cell_y * collision_grid_cell_size +
+                                             (sub_y + 0.5) * field_cell_size);
+                    // Distance to the closest point of each segment
+                    double nearest2 = DBL_MAX;
+                    for (int i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+                        double relx = center.x - cell_rx[i];
+                        double rely = center.y - cell_ry[i];
+                        double t = relx * cell_unit_x[i] + rely * cell_unit_y[i];
+                        if (t < 0.0) {
+                            t = 0.0;
+                        }
+                        if (t > cell_length[i]) {
+                            t = cell_length[i];
+                        }
+                        double dx = relx - cell_unit_x[i] * t;
+                        double dy = rely - cell_unit_y[i] * t;
+                        if (dx * dx + dy * dy < nearest2) {
+                            nearest2 = dx * dx + dy * dy;
+                        }
+                    }
+                    float distance = FLT_MAX;
+                    if (nearest2 < DBL_MAX) {
+                        distance = (float)sqrt(nearest2);
+                    }
+                    field[sub_y * DISTANCE_FIELD_DIVISIONS + sub_x] = distance;
+                }
+            }
+        }
+    }
 }
 
-void segments::iterate_collision_grid_cell_segments(vect2 r) {
-    if (!collision_grid) {
-        internal_error("segments::iterate_collision_grid_cell_segments !collision_grid!");
+collision_cell segments::get_collision_grid_cell(vect2 r) const {
+    if (!cell_start) {
+        internal_error("segments::get_collision_grid_cell !cell_start!");
     }
     // Convert from elmameters to grid position
     // This function is responsible for crashing when you go out of bounds in the up/right direction
@@ -350,34 +434,146 @@ void segments::iterate_collision_grid_cell_segments(vect2 r) {
     }
     if (cell_x > collision_grid_width) {
         internal_error(
-            "segments::iterate_collision_grid_cell_segments cell_x > collision_grid_width!");
+            "segments::get_collision_grid_cell cell_x > collision_grid_width!");
     }
     if (cell_x == collision_grid_width) {
         cell_x = collision_grid_width - 1;
     }
     if (cell_y > collision_grid_height) {
         internal_error(
-            "segments::iterate_collision_grid_cell_segments cell_y > collision_grid_height!");
+            "segments::get_collision_grid_cell cell_y > collision_grid_height!");
     }
     if (cell_y == collision_grid_height) {
         cell_y = collision_grid_height - 1;
     }
-    // We are now ready to iterate
-    collision_grid_iterable = collision_grid[collision_grid_width * cell_y + cell_x];
+    int cell = collision_grid_width * cell_y + cell_x;
+    int first = cell_start[cell];
+
+    // r is outside its cell if it was moved onto the grid above, then there is no bound
+    double clearance = 0.0;
+    double sub_x = (r.x - cell_x) * DISTANCE_FIELD_DIVISIONS;
+    double sub_y = (r.y - cell_y) * DISTANCE_FIELD_DIVISIONS;
+    if (sub_x >= 0.0 && sub_x < DISTANCE_FIELD_DIVISIONS && sub_y >= 0.0 &&
+        sub_y < DISTANCE_FIELD_DIVISIONS) {
+        int block = distance_field_block[cell];
+        if (block < 0) {
+            // No items in the cell
+            clearance = FLT_MAX - distance_field_diagonal;
+        } else {
+            int field_index = (block * DISTANCE_FIELD_DIVISIONS + (int)sub_y) *
+                                  DISTANCE_FIELD_DIVISIONS +
+                              (int)sub_x;
+            clearance = distance_field[field_index] - distance_field_diagonal;
+        }
+    }
+
+    return {cell_start[cell + 1] - first, cell_rx + first,     cell_ry + first,
+            cell_unit_x + first,          cell_unit_y + first, cell_length + first,
+            clearance};
 }
 
-segment* segments::next_collision_grid_segment() {
-    if (!collision_grid_iterable) {
-        return nullptr;
+// Positions outside the grid go to its edge cells, like in get_collision_grid_cell(), but without
+// crashing
+int segments::get_clamped_cell_x(double x) const {
+    x = (x - collision_grid_origin.x) * (1 / collision_grid_cell_size);
+    if (x <= 0) {
+        return 0;
     }
-#ifdef DEBUG
-    if (!collision_grid_iterable->seg) {
-        internal_error("segments::next_collision_grid_segment !collision_grid_iterable->seg");
+    if (x >= collision_grid_width - 1) {
+        return collision_grid_width - 1;
     }
-#endif
-    segment* ret = collision_grid_iterable->seg;
-    collision_grid_iterable = collision_grid_iterable->next;
-    return ret;
+    return (int)x;
+}
+
+int segments::get_clamped_cell_y(double y) const {
+    y = (y - collision_grid_origin.y) * (1 / collision_grid_cell_size);
+    if (y <= 0) {
+        return 0;
+    }
+    if (y >= collision_grid_height - 1) {
+        return collision_grid_height - 1;
+    }
+    return (int)y;
+}
+
+// Objects are counted into the cell of their center, then stored in the same order, so the items
+// of each cell stay in object order. Clamping keeps the cells in order too, so an object in a
+// rectangle is always in the clamped cell range of the rectangle.
+void segments::setup_object_grid(level* lev) {
+    if (!cell_start) {
+        internal_error("segments::setup_object_grid !cell_start!");
+    }
+    delete[] object_cell_start;
+    delete[] object_cell_items;
+
+    int grid_size = collision_grid_width * collision_grid_height;
+    int object_count = (int)lev->objects.size();
+    object_cell_start = new int[grid_size + 1];
+    object_cell_items = new int[object_count + 1];
+    int* object_cells = new int[object_count + 1];
+    if (!object_cell_start || !object_cell_items || !object_cells) {
+        external_error("segments::setup_object_grid out of memory!");
+    }
+    for (int i = 0; i <= grid_size; i++) {
+        object_cell_start[i] = 0;
+    }
+    for (int i = 0; i < object_count; i++) {
+        object* obj = lev->objects[i];
+        object_cells[i] = -1;
+        if (!obj) {
+            continue;
+        }
+        object_cells[i] = collision_grid_width * get_clamped_cell_y(obj->r.y) +
+                          get_clamped_cell_x(obj->r.x);
+        object_cell_start[object_cells[i] + 1]++;
+    }
+    for (int i = 0; i < grid_size; i++) {
+        object_cell_start[i + 1] += object_cell_start[i];
+    }
+
+    int* fill = new int[grid_size];
+    if (!fill) {
+        external_error("segments::setup_object_grid out of memory!");
+    }
+    memcpy(fill, object_cell_start, sizeof(int) * grid_size);
+    for (int i = 0; i < object_count; i++) {
+        if (object_cells[i] >= 0) {
+            object_cell_items[fill[object_cells[i]]++] = i;
+        }
+    }
+    delete[] fill;
+    delete[] object_cells;
+}
+
+void segments::get_object_grid_range(vect2 r1, vect2 r2, int* cell_x1, int* cell_y1,
+                                     int* cell_x2, int* cell_y2) const {
+    *cell_x1 = get_clamped_cell_x(r1.x);
+    *cell_y1 = get_clamped_cell_y(r1.y);
+    *cell_x2 = get_clamped_cell_x(r2.x);
+    *cell_y2 = get_clamped_cell_y(r2.y);
+}
+
+int segments::get_object_grid_cell(int cell_x, int cell_y, const int** object_indices) const {
+    if (!object_cell_start) {
+        internal_error("segments::get_object_grid_cell !object_cell_start!");
+    }
+    int cell = collision_grid_width * cell_y + cell_x;
+    *object_indices = object_cell_items + object_cell_start[cell];
+    return object_cell_start[cell + 1] - object_cell_start[cell];
+}
+
+void segments::get_objects_in_rect(vect2 r1, vect2 r2, std::vector<int>* object_indices) const {
+    object_indices->clear();
+    int cell_x1, cell_y1, cell_x2, cell_y2;
+    get_object_grid_range(r1, r2, &cell_x1, &cell_y1, &cell_x2, &cell_y2);
+    for (int cell_y = cell_y1; cell_y <= cell_y2; cell_y++) {
+        for (int cell_x = cell_x1; cell_x <= cell_x2; cell_x++) {
+            const int* indices;
+            int count = get_object_grid_cell(cell_x, cell_y, &indices);
+            object_indices->insert(object_indices->end(), indices, indices + count);
+        }
+    }
+    std::sort(object_indices->begin(), object_indices->end());
 }
 
 void segments::iterate_all_segments() {
@@ -2,11 +2,17 @@
 #define SEGMENTS_H
 
 #include "vect2.h"
+#include <vector>
 
 class level;
 
+// Largest level width/height, in the original game and with the extended_levels setting
 constexpr int LEVEL_MAX_SIZE = 188;
+constexpr int LEVEL_MAX_SIZE_EXTENDED = 1000;
 constexpr int SEGMENTS_BORDER = 6;
+// Each collision grid cell is split into DISTANCE_FIELD_DIVISIONS x DISTANCE_FIELD_DIVISIONS
+// distance field cells
+constexpr int DISTANCE_FIELD_DIVISIONS = 4;
 
 // A single line segment from a polygon
 struct segment {
@@ -16,27 +22,24 @@ struct segment {
     double length;
 };
 
-// Linked list of level line segments
-struct segment_node {
-    segment* seg;
-    segment_node* next;
-};
-
-typedef segment_node* psegment_node;
-
-// Memory structure to allocate data for segment_node
-constexpr int SEGMENT_NODE_BLOCK_LENGTH = 5000;
-struct segment_node_array {
-    segment_node nodes[SEGMENT_NODE_BLOCK_LENGTH];
-    segment_node_array* next;
+// Potential collision candidates of one collision grid cell, as parallel arrays of `count` items.
+// Item `count` can always be read too (it belongs to the next cell or is padding).
+struct collision_cell {
+    int count;
+    const double* rx;
+    const double* ry;
+    const double* unit_x;
+    const double* unit_y;
+    const double* length;
+    // No item is closer to the looked up position than this (0 if unknown)
+    double clearance;
 };
 
 /* This class contains a list of all the lines in a level (line_list).
  * You can iterate through all the lines using iterate_all_segments() and next_segment().
  * This class also contains physical 2D map of the level with a list of all the lines the kuski
  * might collide with at any given location.
- * You can iterate through potential collision candidates using
- * iterate_collision_grid_cell_segments() and next_collision_grid_segment().
+ * Use get_collision_grid_cell() to get the potential collision candidates at any given location.
  */
 class segments {
     // All line segments in the level
@@ -45,21 +48,43 @@ class segments {
     int seg_list_length;
     int seg_list_iteration_index;
 
-    // 2D grid representing the level for (kuski <-> line segment) collision purposes
-    psegment_node* collision_grid;
+    // 2D grid representing the level for (kuski <-> line segment) collision purposes.
+    // Stored as compressed rows: the candidates of cell i are the items
+    // [cell_start[i], cell_start[i + 1]) of the cell_ arrays, in seg_list order.
+    int* cell_start;
+    double* cell_rx;
+    double* cell_ry;
+    double* cell_unit_x;
+    double* cell_unit_y;
+    double* cell_length;
     int collision_grid_width, collision_grid_height;
     double collision_grid_cell_size;
     vect2 collision_grid_origin;
-    segment_node* collision_grid_iterable;
     // Take one line segment and add it to one or several collision grid cells.
     void add_segment_to_collision_grid(segment* seg, double max_radius);
-    void add_node_to_cell(int cell_x, int cell_y, segment* seg);
+    void add_segment_to_cell(int cell_x, int cell_y, segment* seg);
+    // setup_collision_grid adds every segment twice: first only counting the items of each cell,
+    // then storing them at cell_fill
+    bool counting_cells;
+    int* cell_fill;
 
-    // Memory management
-    segment_node_array* node_array;
-    int node_array_index;
-    segment_node* new_node();
-    void delete_all_nodes();
+    // Coarse distance field: for every distance field cell, the distance from its center to the
+    // nearest item of its collision grid cell. Only collision grid cells with items have one,
+    // distance_field_block[i] is the index of the block of cell i, or -1. Each block is stored
+    // row by row.
+    int* distance_field_block;
+    float* distance_field;
+    // Diagonal of one distance field cell
+    double distance_field_diagonal;
+    void setup_distance_field();
+
+    // Objects of the level bucketed by the collision grid cell of their center, compressed like
+    // the segments: cell i holds object_cell_items [object_cell_start[i], object_cell_start[i + 1])
+    // in object order
+    int* object_cell_start;
+    int* object_cell_items;
+    int get_clamped_cell_x(double x) const;
+    int get_clamped_cell_y(double y) const;
 
   public:
     // Load a list of all the line segments of a level.
@@ -68,11 +93,22 @@ class segments {
 
     // Initialize the collision_grid with the max radius of any interactable bike part
     void setup_collision_grid(double max_radius);
-    // Reset to iterate through all line segments passing through the cell from collision_grid
-    // corresponding to position r
-    void iterate_collision_grid_cell_segments(vect2 r);
-    // Get the next line segment with potential collision from the cell in collision_grid
-    segment* next_collision_grid_segment();
+    // Get all line segments passing through the collision grid cell corresponding to position r
+    collision_cell get_collision_grid_cell(vect2 r) const;
+
+    // Bucket the objects of the level into the collision grid. Call again whenever the objects
+    // move or get reordered, in game after flip_objects() and sort_objects().
+    void setup_object_grid(level* lev);
+    // Get the range of collision grid cells that holds every object with its center in the
+    // rectangle [r1, r2]. The range may contain objects outside the rectangle too.
+    void get_object_grid_range(vect2 r1, vect2 r2, int* cell_x1, int* cell_y1, int* cell_x2,
+                               int* cell_y2) const;
+    // Get the objects of one cell as indices into level::objects in ascending order, and return
+    // their count
+    int get_object_grid_cell(int cell_x, int cell_y, const int** object_indices) const;
+    // Get the indices of all objects with their center in the rectangle [r1, r2] (and maybe a few
+    // more nearby), in ascending order
+    void get_objects_in_rect(vect2 r1, vect2 r2, std::vector<int>* object_indices) const;
 
     // Iterate through all line segments in the level
     void iterate_all_segments();
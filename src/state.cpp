@@ -390,6 +390,9 @@ void state::reset_keys() {
     key_replay_slow_2x = EolSettings->replay_slow_2x_key_default();
     key_replay_slow_4x = EolSettings->replay_slow_4x_key_default();
     key_replay_pause = EolSettings->replay_pause_key_default();
+    key_replay_rewind = EolSettings->replay_rewind_key_default();
+    key_replay_skip_back = EolSettings->replay_skip_back_key_default();
+    key_replay_skip_forward = EolSettings->replay_skip_forward_key_default();
 }
 
 player* state::get_player(const char* player_name) {
@@ -78,6 +78,9 @@ class state {
     DikScancode key_replay_slow_2x;
     DikScancode key_replay_slow_4x;
     DikScancode key_replay_pause;
+    DikScancode key_replay_rewind;
+    DikScancode key_replay_skip_back;
+    DikScancode key_replay_skip_forward;
 
     char editor_filename[20];
     char external_filename[20];
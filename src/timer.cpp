@@ -14,18 +14,19 @@ enum class DigitSegment {
     HORIZONTAL_TOP,
 };
 
-static int DigitLineWidth;
-static int DigitLineHeight;
+// Per thread, as splitscreen viewports may draw their timers at the same time
+static thread_local int DigitLineWidth;
+static thread_local int DigitLineHeight;
 
-static int DigitSpacing;
-static int DigitAndColonSpacing;
+static thread_local int DigitSpacing;
+static thread_local int DigitAndColonSpacing;
 
-static int ColonOffsetX;
-static int ColonOffsetY1;
-static int ColonOffsetY2;
+static thread_local int ColonOffsetX;
+static thread_local int ColonOffsetY1;
+static thread_local int ColonOffsetY2;
 
-static pic8* Dest = nullptr;
-static unsigned char* ReferencePaletteMap = nullptr;
+static thread_local pic8* Dest = nullptr;
+static thread_local unsigned char* ReferencePaletteMap = nullptr;
 
 // Draw horizontal line for the ingame timer, using the provided palette map
 static void horizontal_line(pic8* dest, int x, int y, int size, unsigned char* lookup) {
@@ -0,0 +1,82 @@
+#include "worker_pool.h"
+
+// Set while the current thread runs a job, nested batches then run inline
+static thread_local bool InPoolJob = false;
+
+worker_pool::worker_pool(int size) {
+    job = nullptr;
+    job_count = 0;
+    next_index = 0;
+    remaining = 0;
+    generation = 0;
+    stopping = false;
+    for (int i = 1; i < size; i++) {
+        threads.emplace_back(&worker_pool::thread_main, this);
+    }
+}
+
+worker_pool::~worker_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void worker_pool::work(std::unique_lock<std::mutex>& lock, unsigned job_generation) {
+    while (generation == job_generation && next_index < job_count) {
+        int index = next_index++;
+        const std::function<void(int)>* current_job = job;
+        lock.unlock();
+        bool outer = InPoolJob;
+        InPoolJob = true;
+        (*current_job)(index);
+        InPoolJob = outer;
+        lock.lock();
+        remaining--;
+        if (remaining == 0) {
+            work_done.notify_all();
+        }
+    }
+}
+
+void worker_pool::thread_main() {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned seen_generation = generation;
+    while (true) {
+        work_ready.wait(lock, [&] { return stopping || generation != seen_generation; });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+        work(lock, seen_generation);
+    }
+}
+
+void worker_pool::run(int count, const std::function<void(int)>& job_p) {
+    if (count <= 0) {
+        return;
+    }
+    if (threads.empty() || count == 1 || InPoolJob) {
+        for (int i = 0; i < count; i++) {
+            job_p(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &job_p;
+    job_count = count;
+    next_index = 0;
+    remaining = count;
+    generation++;
+    work_ready.notify_all();
+
+    work(lock, generation);
+    work_done.wait(lock, [&] { return remaining == 0; });
+    job = nullptr;
+}
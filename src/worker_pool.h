@@ -0,0 +1,39 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small persistent thread pool for splitting per-frame work into independent tasks.
+// The calling thread also works on tasks, so a pool of size 1 starts no threads.
+class worker_pool {
+    std::mutex mutex;
+    std::mutex run_mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+
+    const std::function<void(int)>* job;
+    int job_count;
+    int next_index;
+    int remaining;
+    unsigned generation;
+    bool stopping;
+    std::vector<std::thread> threads;
+
+    void work(std::unique_lock<std::mutex>& lock, unsigned job_generation);
+    void thread_main();
+
+  public:
+    explicit worker_pool(int size);
+    ~worker_pool();
+    int size() const { return (int)threads.size() + 1; }
+    // Calls job(i) for every i in [0, count) and returns once all calls finished.
+    // Batches from different callers are run one after the other.
+    // Called from inside a job of any pool, the batch runs inline on the calling thread.
+    void run(int count, const std::function<void(int)>& job);
+};
+
+#endif
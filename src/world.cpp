@@ -0,0 +1,147 @@
+#include "world.h"
+#include "EDITUJ.H"
+#include "LEJATSZO.H"
+#include "LEPTET.H"
+#include "main.h"
+#include "object.h"
+#include "physics_init.h"
+#include "segments.h"
+
+void event_buffer::add(WavEvent event_id, double volume, int object_id) {
+    events.push_back({event_id, volume, object_id});
+}
+
+bool event_buffer::get(WavEvent* event_id, double* volume, int* object_id) {
+    if (next == events.size()) {
+        reset();
+        return false;
+    }
+    *event_id = events[next].event_id;
+    *volume = events[next].volume;
+    *object_id = events[next].object_id;
+    next++;
+    return true;
+}
+
+world::world() {
+    owns_data = false;
+    lev = nullptr;
+    segs = nullptr;
+    motor1 = nullptr;
+    motor2 = nullptr;
+    rec1 = nullptr;
+    rec2 = nullptr;
+    single = 1;
+    tag = 0;
+    max_friction = 0;
+}
+
+world::world(const char* level_filename) : world() {
+    level* loaded = new level(level_filename);
+    if (loaded->topology_errors) {
+        external_error("Level file has some topology errors!", level_filename);
+    }
+    setup(loaded);
+}
+
+world::world(level* level_to_own) : world() { setup(level_to_own); }
+
+void world::setup(level* level_to_own) {
+    owns_data = true;
+    lev = level_to_own;
+
+    motor1 = new motorst;
+    motor2 = new motorst;
+    init_motor(motor1);
+    init_motor(motor2);
+
+    // Same as floadlevel_p()
+    segs = new segments(lev);
+    if (HeadRadius > motor1->left_wheel.radius) {
+        segs->setup_collision_grid(HeadRadius);
+    } else {
+        segs->setup_collision_grid(motor1->left_wheel.radius);
+    }
+
+    // Same as lejatszo()
+    lev->flip_objects();
+    lev->sort_objects();
+    segs->setup_object_grid(lev);
+    lev->initialize_objects(motor1);
+    lev->initialize_objects(motor2);
+    resetleptet(motor1);
+    resetleptet(motor2);
+}
+
+world::~world() {
+    if (!owns_data) {
+        return;
+    }
+    delete motor1;
+    delete motor2;
+    delete segs;
+    delete lev;
+}
+
+void world::snapshot(world_snapshot* snap, double time) const {
+    snap->time = time;
+    snap->motor1 = *motor1;
+    snap->motor2 = *motor2;
+    snap->max_friction = max_friction;
+
+    if (lev->objects.size() > MAX_LOADED_OBJECTS) {
+        internal_error("world::snapshot too many objects!");
+    }
+    snap->object_count = lev->objects.size();
+    for (int i = 0; i < snap->object_count; i++) {
+        snap->object_active[i] = lev->objects[i]->active;
+    }
+
+    if (tag) {
+        snap->flagtag = flagtag_save();
+    }
+    if (rec1) {
+        snap->rec1 = rec1->store_position();
+    }
+    if (rec2) {
+        snap->rec2 = rec2->store_position();
+    }
+}
+
+double world::restore(const world_snapshot& snap) {
+    *motor1 = snap.motor1;
+    *motor2 = snap.motor2;
+    max_friction = snap.max_friction;
+    events.reset();
+
+    if (snap.object_count != (int)lev->objects.size()) {
+        internal_error("world::restore snapshot of another level!");
+    }
+    for (int i = 0; i < snap.object_count; i++) {
+        lev->objects[i]->active = snap.object_active[i];
+    }
+
+    if (tag) {
+        flagtag_restore(snap.flagtag);
+    }
+    if (rec1) {
+        rec1->set_store_position(snap.rec1);
+    }
+    if (rec2) {
+        rec2->set_store_position(snap.rec2);
+    }
+    return snap.time;
+}
+
+world* game_world() {
+    static world GameWorld;
+    GameWorld.lev = Ptop;
+    GameWorld.segs = Segments;
+    GameWorld.motor1 = Motor1;
+    GameWorld.motor2 = Motor2;
+    GameWorld.rec1 = Rec1;
+    GameWorld.rec2 = Rec2;
+    GameWorld.single = Single;
+    GameWorld.tag = Tag;
+    return &GameWorld;
+}
@@ -0,0 +1,102 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "flagtag.h"
+#include "level.h"
+#include "physics_init.h"
+#include "recorder.h"
+#include "sound_engine.h"
+#include <bitset>
+#include <type_traits>
+#include <vector>
+
+class segments;
+
+// Sounds and touched objects of the current physics step, in the order they happened.
+// Grows as needed: a bike in a dense cluster of apples can eat many of them in one step.
+class event_buffer {
+    struct event {
+        WavEvent event_id;
+        double volume;
+        int object_id;
+    };
+    std::vector<event> events;
+    // Events before this one have been got already
+    size_t next;
+
+  public:
+    event_buffer() : next(0) {}
+
+    void add(WavEvent event_id, double volume, int object_id);
+    void reset() {
+        events.clear();
+        next = 0;
+    }
+    // Return true if a new event has been obtained
+    bool get(WavEvent* event_id, double* volume, int* object_id);
+};
+
+// Complete gameplay state of a world at one point of the physics clock, for instant rewind and
+// search. Plain data of a fixed size, copy it around freely.
+struct world_snapshot {
+    double time;
+    motorst motor1;
+    motorst motor2;
+    double max_friction;
+    int object_count;
+    std::bitset<MAX_LOADED_OBJECTS> object_active;
+    // The flag tag state is global (flagtag.h), saved only in flag tag worlds
+    flagtag_state flagtag;
+    // Saved only for the recorders the world has
+    recorder_position rec1;
+    recorder_position rec2;
+};
+static_assert(std::is_trivially_copyable<world_snapshot>::value);
+
+// Everything one simulation reads and writes, apart from the constants of physics_init.h:
+// the level and its objects, the collision grid, both bikes, the game mode and the state
+// leptet() keeps between calls.
+//
+// The game runs on game_world(), a view of Ptop, Segments, Motor1/Motor2, Rec1/Rec2 and
+// Single/Tag. Tools can load any number of independent worlds and step each one on its own thread.
+class world {
+    bool owns_data;
+    void setup(level* level_to_own);
+
+  public:
+    level* lev;
+    segments* segs;
+    motorst* motor1;
+    motorst* motor2;
+    // Replays being recorded, or null
+    recorder* rec1;
+    recorder* rec2;
+    int single;
+    int tag; // Flag tag
+    event_buffer events;
+    // Largest friction of the last leptet(), for the creak sound
+    double max_friction;
+
+    // Empty world, see game_world()
+    world();
+    // Independent world with its own level, collision grid and both bikes on the start, as
+    // lejatszo() would set them up. Needs init_physics_data(). Load worlds from one thread only,
+    // as level files are read through the shared qopen state.
+    explicit world(const char* level_filename);
+    // Same on a level built in memory (unflipped, as loaded from a file), deleted with the world
+    explicit world(level* level_to_own);
+    ~world();
+
+    // Save the state at physics time `time`, between two steps
+    void snapshot(world_snapshot* snap, double time) const;
+    // Return to a snapshot of this world and return its physics time
+    double restore(const world_snapshot& snap);
+
+    world(const world&) = delete;
+    world& operator=(const world&) = delete;
+};
+
+// The world of the game, with its pointers refreshed from the globals
+world* game_world();
+
+#endif